@@ -2,11 +2,48 @@
 #define ROUGH_CORE_H
 
 #include <array>
+#include <cstddef>
+#include <cstdint>
 
 namespace Rough {
 
-typedef std::array<double, 2> Point;
-typedef std::array<Point, 2> Line;
+// Coordinates are stored in single precision in builds defining
+// ROUGH_SINGLE_PRECISION (make float), sketchy output does not need more
+#ifdef ROUGH_SINGLE_PRECISION
+typedef float Scalar;
+#else
+typedef double Scalar;
+#endif
+
+template <class T> using BasicPoint = std::array<T, 2>;
+template <class T> using BasicLine = std::array<BasicPoint<T>, 2>;
+
+typedef BasicPoint<Scalar> Point;
+typedef BasicLine<Scalar> Line;
+
+// A point from coordinates computed in double precision, taken as a braced
+// list, so that they are still evaluated from left to right
+template <class T = Scalar>
+inline BasicPoint<T> makePoint(const BasicPoint<double> &p)
+{
+	return BasicPoint<T>{ static_cast<T>(p[0]), static_cast<T>(p[1]) };
+}
+
+// Adaptive subdivides curves until they are flat enough, FixedCount
+// computes the number of points per curve up front (Wang's formula)
+enum class CurveFlattening
+{
+	Adaptive,
+	FixedCount
+};
+
+enum class FillStyle
+{
+	Hachure,
+	CrossHatch,
+	ZigZag,
+	Dots
+};
 
 struct RoughOptions {
 	double maxRandomnessOffset;
@@ -20,6 +57,17 @@ struct RoughOptions {
 	double hachureAngle;
 	double hachureGap;
 	double strokeWidth;
+	CurveFlattening curveFlattening;
+	size_t fillPointBudget;
+	FillStyle fillStyle;
+	// 0 draws from rand(), any other seed from a generator of its own
+	uint64_t seed;
+	// level of detail, shapes whose bounding box is smaller than
+	// lodStrokeExtent are drawn with a single stroke and fewer ellipse
+	// steps, fills smaller than lodFillExtent become a single stroke around
+	// the shape; 0 turns them off
+	double lodStrokeExtent;
+	double lodFillExtent;
 };
 
 }
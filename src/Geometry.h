@@ -2,13 +2,15 @@
 #ifndef ROUGH_GEOMETRY_H
 #define ROUGH_GEOMETRY_H
 
+#include <algorithm>
 #include <array>
+#include <cstdint>
 #include <vector>
 #include <math.h>
 #include <ranges>
 #include <utility>
 #include <optional>
-#include <limits>
+#include <span>
 
 #include "Core.h"
 
@@ -23,40 +25,89 @@ struct Rectangle
 	double height;
 };
 
-inline bool doIntersect(Point p1, Point q1, Point p2, Point q2);
-inline int orientation(Point p, Point q, Point r);
-inline bool onSegment(Point p, Point q, Point r);
+// cos and sin of an angle, rotations add angles without calling cos() and
+// sin() again
+struct UnitVector
+{
+	static UnitVector of(double angle)
+	{
+		return UnitVector{ cos(angle), sin(angle) };
+	}
+
+	UnitVector rotated(const UnitVector &by) const
+	{
+		return UnitVector{ cosine * by.cosine - sine * by.sine, sine * by.cosine + cosine * by.sine };
+	}
+	UnitVector inverse() const
+	{
+		return UnitVector{ cosine, -sine };
+	}
+
+	double cosine;
+	double sine;
+};
 
-template <class RangeT>
-inline void rotatePoints(RangeT &&points, Point center, double degrees)
+// The unit vectors of start, start + step, start + 2 * step, ... by rotating
+// the previous one. Every few steps the length is pulled back to 1, so the
+// rounding errors of the rotations don't make the vector grow or shrink.
+class AngleSteps
 {
-	if(points.begin() != points.end()) {
-		const double cx = center[0], cy = center[1];
-		const double angle = (M_PI / 180) * degrees;
-		const double cos = ::cos(angle);
-		const double sin = ::sin(angle);
-		for(auto &p : points) {
-			double x = p[0], y = p[1];
-			p[0] = ((x - cx) * cos) - ((y - cy) * sin) + cx;
-			p[1] = ((x - cx) * sin) + ((y - cy) * cos) + cy;
+public:
+	AngleSteps(const UnitVector &start, const UnitVector &step)
+		: current(start), step(step)
+	{
+	}
+
+	const UnitVector &operator*() const { return current; }
+	const UnitVector *operator->() const { return &current; }
+
+	AngleSteps &operator++()
+	{
+		current = current.rotated(step);
+		if(++count % RENORMALIZE_STEPS == 0) {
+			// one Newton step of 1 / sqrt(length²), enough as it is close to 1
+			const double scale = (3 - (current.cosine * current.cosine + current.sine * current.sine)) / 2;
+			current.cosine *= scale;
+			current.sine *= scale;
 		}
+		return *this;
 	}
-}
 
-inline void rotateLines(std::vector<Line> &lines, Point center, double degrees)
+private:
+	static constexpr unsigned RENORMALIZE_STEPS = 16;
+
+	UnitVector current;
+	UnitVector step;
+	unsigned count = 0;
+};
+
+// All of these are templates on the scalar type of the points
+
+template <class T> inline bool doIntersect(BasicPoint<T> p1, BasicPoint<T> q1, BasicPoint<T> p2, BasicPoint<T> q2);
+template <class T> inline int orientation(BasicPoint<T> p, BasicPoint<T> q, BasicPoint<T> r);
+template <class T> inline bool onSegment(BasicPoint<T> p, BasicPoint<T> q, BasicPoint<T> r);
+
+template <class T>
+inline BasicPoint<T> rotatePoint(const BasicPoint<T> &p, const BasicPoint<T> &center, double cos, double sin)
 {
-	std::vector<Point> points;
-	rotatePoints(std::ranges::join_view(lines), center, degrees);
+	const double cx = center[0], cy = center[1];
+	const double x = p[0], y = p[1];
+	return makePoint<T>({
+		((x - cx) * cos) - ((y - cy) * sin) + cx,
+		((x - cx) * sin) + ((y - cy) * cos) + cy
+	});
 }
 
-inline double lineLength(const Line &line)
+template <class T>
+inline double lineLength(const BasicLine<T> &line)
 {
-	const Point p1 = line[0];
-	const Point p2 = line[1];
+	const BasicPoint<T> p1 = line[0];
+	const BasicPoint<T> p2 = line[1];
 	return sqrt(pow(p1[0] - p2[0], 2) + pow(p1[1] - p2[1], 2));
 }
 
-inline std::optional<Point> lineIntersection(Point a, Point b, Point c, Point d)
+template <class T>
+inline std::optional<BasicPoint<T>> lineIntersection(BasicPoint<T> a, BasicPoint<T> b, BasicPoint<T> c, BasicPoint<T> d)
 {
 	const double a1 = b[1] - a[1];
 	const double b1 = a[0] - b[0];
@@ -65,36 +116,208 @@ inline std::optional<Point> lineIntersection(Point a, Point b, Point c, Point d)
 	const double b2 = c[0] - d[0];
 	const double c2 = a2 * (c[0]) + b2 * (c[1]);
 	const double determinant = a1 * b2 - a2 * b1;
-	return determinant != 0.0 ? std::optional<Point>{ Point{(b2 * c1 - b1 * c2) / determinant, (a1 * c2 - a2 * c1) / determinant} } : std::nullopt; // TODO: compare against double?
+	return determinant != 0.0 ? std::optional<BasicPoint<T>>{ makePoint<T>({(b2 * c1 - b1 * c2) / determinant, (a1 * c2 - a2 * c1) / determinant}) } : std::nullopt; // TODO: compare against double?
 }
 
-inline bool isPointInPolygon(const std::vector<Point> points, double x, double y)
+// The edges of a polygon bucketed by their y-range, built once per fill so
+// that intersection tests only visit the edges near the queried y instead
+// of all of them. The results equal those of doIntersect on the whole
+// polygon, edges outside the y-range of a query cannot intersect it.
+template <class T>
+class EdgeIndex
 {
-	const size_t vertices = points.size();
-
-	// There must be at least 3 vertices in polygon
-	if(vertices < 3) {
-		return false;
-	}
-	const Point extreme{std::numeric_limits<double>::max(), y}; // TODO: is max double ok? was MAX_SAFE_INT in JS...
-	const Point p{x, y};
-	size_t count = 0;
-	for(size_t i = 0; i < vertices; i++) {
-		const Point current = points[i];
-		const Point next = points[(i + 1) % vertices];
-		if(doIntersect(current, next, p, extreme)) {
-			if(orientation(current, p, next) == 0) {
-				return onSegment(current, p, next);
+public:
+	EdgeIndex(std::span<const BasicPoint<T>> polygon)
+		: polygon(polygon)
+	{
+		const size_t vertices = polygon.size();
+		if(vertices > 0) {
+			const auto [minPoint, maxPoint] = std::ranges::minmax(polygon, {}, [](const BasicPoint<T> &p) { return p[1]; });
+			top = minPoint[1];
+			const double height = maxPoint[1] - top;
+			if(height > 0 && std::isfinite(height)) {
+				bucketCount = std::max<size_t>(1, 4 * sqrt(vertices));
+				scale = bucketCount / height;
+			}
+		}
+
+		// edges spanning several buckets are listed in all of them, each
+		// bucket holds its edges in polygon order
+		bucketOffsets.assign(bucketCount + 1, 0);
+		for(size_t i = 0; i < vertices; i++) {
+			const auto [first, last] = bucketRange(i);
+			for(size_t b = first; b <= last; b++) {
+				bucketOffsets[b + 1]++;
+			}
+		}
+		for(size_t b = 0; b < bucketCount; b++) {
+			bucketOffsets[b + 1] += bucketOffsets[b];
+		}
+		bucketEdges.resize(bucketOffsets.back());
+		std::vector<size_t> cursor(bucketOffsets.begin(), bucketOffsets.end() - 1);
+		for(size_t i = 0; i < vertices; i++) {
+			const auto [first, last] = bucketRange(i);
+			for(size_t b = first; b <= last; b++) {
+				bucketEdges[cursor[b]++] = i;
 			}
-			count++;
 		}
 	}
-	// true if count is off
-	return count % 2 == 1;
-}
+
+	// the edge from vertex i to the next one, the last edge closes the polygon
+	BasicLine<T> edge(size_t i) const
+	{
+		return BasicLine<T>{ polygon[i], polygon[(i + 1) % polygon.size()] };
+	}
+
+	// Collects the edges whose y-range overlaps y0 to y1, in polygon order
+	void edgesInRange(double y0, double y1, std::vector<size_t> &out) const
+	{
+		out.clear();
+		const size_t first = bucketOf(y0), last = bucketOf(y1);
+		for(size_t b = first; b <= last; b++) {
+			for(size_t k = bucketOffsets[b]; k < bucketOffsets[b + 1]; k++) {
+				const BasicLine<T> e = edge(bucketEdges[k]);
+				if(std::max(e[0][1], e[1][1]) >= y0 && std::min(e[0][1], e[1][1]) <= y1) {
+					out.push_back(bucketEdges[k]);
+				}
+			}
+		}
+		if(first != last) {
+			std::ranges::sort(out);
+			const auto duplicates = std::ranges::unique(out);
+			out.erase(duplicates.begin(), duplicates.end());
+		}
+	}
+
+	// The buckets are stored one after another, slot k lists the edge
+	// slots()[k]. The slots of the bucket holding y contain every edge
+	// whose y-range includes y.
+	std::span<const size_t> slots() const { return bucketEdges; }
+	std::pair<size_t, size_t> slotRange(double y) const
+	{
+		const size_t b = bucketOf(y);
+		return { bucketOffsets[b], bucketOffsets[b + 1] };
+	}
+
+private:
+	size_t bucketOf(double y) const
+	{
+		const double b = (y - top) * scale;
+		if(!(b >= 0)) {
+			return 0;
+		}
+		return b < bucketCount ? static_cast<size_t>(b) : bucketCount - 1;
+	}
+
+	std::pair<size_t, size_t> bucketRange(size_t i) const
+	{
+		const BasicLine<T> e = edge(i);
+		return { bucketOf(std::min(e[0][1], e[1][1])), bucketOf(std::max(e[0][1], e[1][1])) };
+	}
+
+	std::span<const BasicPoint<T>> polygon;
+	double top = 0;
+	double scale = 0;
+	size_t bucketCount = 1;
+	std::vector<size_t> bucketOffsets;
+	std::vector<size_t> bucketEdges;
+};
+
+// A polygon prepared once per fill for many containment queries. Besides
+// the edge index it keeps the bounding box for a quick reject and the edges
+// in the order of the index slots, so that a query runs a branchless
+// winding number loop over the contiguous slots of a single bucket. Like
+// the scanline fill, points are inside if the winding number is odd, and
+// like the ray casting test of rough.js points on an edge are inside.
+template <class T>
+class PreparedPolygon
+{
+public:
+	PreparedPolygon(std::span<const BasicPoint<T>> polygon)
+		: index(polygon)
+	{
+		if(polygon.size() < 3) {
+			return;
+		}
+		const auto [minX, maxX] = std::ranges::minmax(polygon | std::views::transform([](const BasicPoint<T> &p) { return p[0]; }));
+		const auto [minY, maxY] = std::ranges::minmax(polygon | std::views::transform([](const BasicPoint<T> &p) { return p[1]; }));
+		bounds = { minX, minY, maxX, maxY };
+
+		const std::span<const size_t> slots = index.slots();
+		x0.resize(slots.size());
+		y0.resize(slots.size());
+		x1.resize(slots.size());
+		y1.resize(slots.size());
+		dx.resize(slots.size());
+		dy.resize(slots.size());
+		for(size_t k = 0; k < slots.size(); k++) {
+			const BasicLine<T> e = index.edge(slots[k]);
+			x0[k] = e[0][0];
+			y0[k] = e[0][1];
+			x1[k] = e[1][0];
+			y1[k] = e[1][1];
+			dx[k] = e[1][0] - e[0][0];
+			dy[k] = e[1][1] - e[0][1];
+		}
+	}
+
+	const EdgeIndex<T> &edges() const { return index; }
+
+	bool contains(T x, T y) const
+	{
+		return !x0.empty() && inBounds(x, y) && inBucket(x, y);
+	}
+
+	// contains() for all points, inside[i] is set to 1 if points[i] is
+	// inside. The bounding box reject runs over the whole span first, only
+	// the points within it run the loop over the slots of their bucket.
+	void contains(std::span<const BasicPoint<T>> points, std::span<uint8_t> inside) const
+	{
+		if(x0.empty()) {
+			std::ranges::fill(inside, 0);
+			return;
+		}
+		for(size_t i = 0; i < points.size(); i++) {
+			inside[i] = inBounds(points[i][0], points[i][1]);
+		}
+		for(size_t i = 0; i < points.size(); i++) {
+			if(inside[i]) {
+				inside[i] = inBucket(points[i][0], points[i][1]);
+			}
+		}
+	}
+
+private:
+	bool inBounds(T x, T y) const
+	{
+		return (x >= bounds[0]) & (y >= bounds[1]) & (x <= bounds[2]) & (y <= bounds[3]);
+	}
+
+	bool inBucket(T x, T y) const
+	{
+		const auto [first, last] = index.slotRange(y);
+		int winding = 0;
+		bool onEdge = false;
+		for(size_t k = first; k < last; k++) {
+			const T isLeft = dx[k] * (y - y0[k]) - (x - x0[k]) * dy[k];
+			winding += (y0[k] <= y) & (y1[k] > y) & (isLeft > 0);
+			winding -= (y1[k] <= y) & (y0[k] > y) & (isLeft < 0);
+			onEdge |= (isLeft == 0) &
+				(std::min(x0[k], x1[k]) <= x) & (x <= std::max(x0[k], x1[k])) &
+				(std::min(y0[k], y1[k]) <= y) & (y <= std::max(y0[k], y1[k]));
+		}
+		return onEdge || winding % 2 != 0;
+	}
+
+	EdgeIndex<T> index;
+	// minimum x, minimum y, maximum x, maximum y
+	std::array<T, 4> bounds{};
+	std::vector<T> x0, y0, x1, y1, dx, dy;
+};
 
 // Check if q lies on the line segment pr
-inline bool onSegment(Point p, Point q, Point r)
+template <class T>
+inline bool onSegment(BasicPoint<T> p, BasicPoint<T> q, BasicPoint<T> r)
 {
 	return(
 			q[0] <= std::max(p[0], r[0]) &&
@@ -108,7 +331,8 @@ inline bool onSegment(Point p, Point q, Point r)
 // 0 if p, q, r are collinear
 // 1 if Clockwise
 // 2 if counterclickwise
-inline int orientation(Point p, Point q, Point r)
+template <class T>
+inline int orientation(BasicPoint<T> p, BasicPoint<T> q, BasicPoint<T> r)
 {
 	const double val = (q[1] - p[1]) * (r[0] - q[0]) - (q[0] - p[0]) * (r[1] - q[1]);
 	if(val == 0) {
@@ -118,7 +342,8 @@ inline int orientation(Point p, Point q, Point r)
 }
 
 // Check is p1q1 intersects with p2q2
-inline bool doIntersect(Point p1, Point q1, Point p2, Point q2)
+template <class T>
+inline bool doIntersect(BasicPoint<T> p1, BasicPoint<T> q1, BasicPoint<T> p2, BasicPoint<T> q2)
 {
 	const int o1 = orientation(p1, q1, p2);
 	const int o2 = orientation(p1, q1, q2);
@@ -0,0 +1,31 @@
+#ifndef ROUGH_GRAPHICS_H
+#define ROUGH_GRAPHICS_H
+
+#include <concepts>
+
+namespace Rough {
+
+// What the renderer draws into, it is a template parameter of the renderer
+// so that the calls are resolved at compile time and can be inlined
+template <class T>
+concept GraphicsSink = requires(T &sink, double x, double y)
+{
+	sink.moveTo(x, y);
+	sink.lineTo(x, y);
+	sink.bezierCurveTo(x, y, x, y, x, y);
+};
+
+// A sink chosen at runtime, for backends that can't be templates
+class Graphics
+{
+public:
+	virtual void moveTo(double x, double y) = 0;
+	virtual void lineTo(double x, double y) = 0;
+	virtual void bezierCurveTo(double x1, double y1, double x2, double y2, double x3, double y3) = 0;
+};
+
+static_assert(GraphicsSink<Graphics>);
+
+} /* namespace Rough */
+
+#endif /* ROUGH_GRAPHICS_H */
@@ -0,0 +1,27 @@
+#include "OpSet.h"
+
+#include <charconv>
+
+namespace Rough
+{
+
+void opsToPath(const OpSet &ops, std::string &path)
+{
+	static constexpr char COMMANDS[] = {'M', 'L', 'C'};
+
+	// the same as std::to_string(), "%f", without the formatting overhead
+	char number[400];
+	const double *c = ops.coordinates().data();
+	for(OpType type : ops.types()) {
+		path += COMMANDS[static_cast<size_t>(type)];
+		path += ' ';
+		for(size_t i = 0; i < opCoordinates(type); i++) {
+			const auto result = std::to_chars(number, number + sizeof(number), c[i], std::chars_format::fixed, 6);
+			path.append(number, result.ptr);
+			path += ' ';
+		}
+		c += opCoordinates(type);
+	}
+}
+
+} /* namespace Rough */
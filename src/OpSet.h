@@ -0,0 +1,87 @@
+#ifndef ROUGH_OPSET_H
+#define ROUGH_OPSET_H
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "Graphics.h"
+
+namespace Rough {
+
+enum class OpType : uint8_t {Move, LineTo, BezierCurveTo};
+
+// number of coordinates following an op
+constexpr size_t opCoordinates(OpType type)
+{
+	return type == OpType::BezierCurveTo ? 6 : 2;
+}
+
+// The drawing operations of the renderer like the OpSet of rough.js: the
+// type of each op in order and the coordinates of all ops one after the
+// other, so that passes and backends can run over the whole buffer.
+class OpSet
+{
+public:
+	void moveTo(double x, double y)
+	{
+		opTypes.push_back(OpType::Move);
+		coords.insert(coords.end(), {x, y});
+	}
+	void lineTo(double x, double y)
+	{
+		opTypes.push_back(OpType::LineTo);
+		coords.insert(coords.end(), {x, y});
+	}
+	void bezierCurveTo(double x1, double y1, double x2, double y2, double x3, double y3)
+	{
+		opTypes.push_back(OpType::BezierCurveTo);
+		coords.insert(coords.end(), {x1, y1, x2, y2, x3, y3});
+	}
+
+	size_t size() const { return opTypes.size(); }
+	bool empty() const { return opTypes.empty(); }
+	// keeps the memory for the next ops
+	void clear()
+	{
+		opTypes.clear();
+		coords.clear();
+	}
+
+	std::span<const OpType> types() const { return opTypes; }
+	std::span<const double> coordinates() const { return coords; }
+
+	// hands all ops in order to sink
+	template <GraphicsSink Sink>
+	void replay(Sink &sink) const
+	{
+		const double *c = coords.data();
+		for(OpType type : opTypes) {
+			switch(type) {
+				case OpType::Move:
+					sink.moveTo(c[0], c[1]);
+					break;
+				case OpType::LineTo:
+					sink.lineTo(c[0], c[1]);
+					break;
+				case OpType::BezierCurveTo:
+					sink.bezierCurveTo(c[0], c[1], c[2], c[3], c[4], c[5]);
+					break;
+			}
+			c += opCoordinates(type);
+		}
+	}
+
+private:
+	std::vector<OpType> opTypes;
+	std::vector<double> coords;
+};
+
+// the ops as the d attribute of an SVG path, appended to path
+void opsToPath(const OpSet &ops, std::string &path);
+
+} /* namespace Rough */
+
+#endif /* ROUGH_OPSET_H */
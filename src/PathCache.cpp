@@ -0,0 +1,65 @@
+#include "PathCache.h"
+
+#include "PathDataParser/Traverse.h"
+
+namespace Rough
+{
+
+PathCache::Entry &PathCache::lookup(std::string_view d, Source source)
+{
+	Entries &sourceEntries = entries[static_cast<size_t>(source)];
+	auto it = sourceEntries.find(d);
+	if(it == sourceEntries.end()) {
+		PathDataParser::Path normalized = source == Source::Points ? PathDataParser::normalizedPoints(d) : PathDataParser::normalizedPath(d);
+		it = sourceEntries.emplace(std::string(d), Entry{ .normalized = std::move(normalized), .points = std::nullopt, .tolerance = 0, .distance = 0, .flattening = CurveFlattening::Adaptive, .pointBudget = 0, .element = 0, .missed = false }).first;
+		count(it->second, true);
+	} else {
+		count(it->second, false);
+	}
+	return it->second;
+}
+
+void PathCache::count(Entry &entry, bool miss)
+{
+	if(entry.element != element) {
+		entry.element = element;
+		entry.missed = miss;
+		if(miss) {
+			missCount++;
+		} else {
+			hitCount++;
+		}
+	} else if(miss && !entry.missed) {
+		// counted as a hit earlier in this element, but work was needed
+		entry.missed = true;
+		hitCount--;
+		missCount++;
+	}
+}
+
+const PathDataParser::Path &PathCache::normalized(std::string_view d, Source source)
+{
+	return lookup(d, source).normalized;
+}
+
+const PointsOnPath::PointRings &PathCache::pointsOnPath(std::string_view d, double tolerance, double distance, CurveFlattening flattening, size_t pointBudget, Source source)
+{
+	Entry &entry = lookup(d, source);
+	if(!entry.points.has_value() || entry.tolerance != tolerance || entry.distance != distance || entry.flattening != flattening || entry.pointBudget != pointBudget) {
+		entry.points = PointsOnPath::pointRingsOnPath(entry.normalized, tolerance, distance, flattening, pointBudget);
+		entry.tolerance = tolerance;
+		entry.distance = distance;
+		entry.flattening = flattening;
+		entry.pointBudget = pointBudget;
+		count(entry, true);
+	}
+	return entry.points.value();
+}
+
+double PathCache::hitRate() const
+{
+	const size_t lookups = hitCount + missCount;
+	return lookups ? (double) hitCount / lookups : 0.0;
+}
+
+} /* namespace Rough */
@@ -0,0 +1,77 @@
+#ifndef ROUGH_PATH_CACHE_H
+#define ROUGH_PATH_CACHE_H
+
+#include <array>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "Core.h"
+#include "PathDataParser/Parser.h"
+#include "PointsOnPath/PointsOnPath.h"
+
+namespace Rough {
+
+// Keeps the normalized segments and the flattened points of every distinct
+// path data of a document, so that filling and stroking the same geometry
+// or repeated geometry (like arrowheads) is parsed and flattened only once.
+class PathCache
+{
+public:
+	// what the strings handed to the cache hold
+	enum class Source
+	{
+		PathData,
+		// the points attribute of a polygon or polyline
+		Points
+	};
+
+	const PathDataParser::Path &normalized(std::string_view d, Source source = Source::PathData);
+	const PointsOnPath::PointRings &pointsOnPath(std::string_view d, double tolerance, double distance, CurveFlattening flattening = CurveFlattening::Adaptive, size_t pointBudget = 0, Source source = Source::PathData);
+
+	// The statistics count each geometry once per element, as a hit if it
+	// was known from an earlier element and needed no work, thus filling and
+	// stroking the same geometry doesn't inflate the hit rate
+	void beginElement() { element++; }
+	size_t hits() const { return hitCount; }
+	size_t misses() const { return missCount; }
+	double hitRate() const;
+
+private:
+	struct Entry
+	{
+		PathDataParser::Path normalized;
+		std::optional<PointsOnPath::PointRings> points;
+		double tolerance;
+		double distance;
+		CurveFlattening flattening;
+		size_t pointBudget;
+		// the element the entry was last counted for and how
+		size_t element;
+		bool missed;
+	};
+
+	struct StringHash
+	{
+		using is_transparent = void;
+		size_t operator()(std::string_view s) const { return std::hash<std::string_view>{}(s); }
+	};
+
+	using Entries = std::unordered_map<std::string, Entry, StringHash, std::equal_to<>>;
+
+	Entry &lookup(std::string_view d, Source source);
+	void count(Entry &entry, bool miss);
+
+	// path data and points are kept apart, the same string means different
+	// geometries in both
+	std::array<Entries, 2> entries;
+	size_t element = 1;
+	size_t hitCount = 0;
+	size_t missCount = 0;
+};
+
+}
+
+#endif /* ROUGH_PATH_CACHE_H */
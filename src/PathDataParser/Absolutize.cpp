@@ -1,112 +1,115 @@
 #include "Absolutize.h"
 
+#include <array>
+
 namespace Rough {
 namespace PathDataParser {
 
-std::vector<Segment> absolutize(const std::vector<Segment> &segments)
+Path absolutize(const Path &segments)
 {
 	double cx = 0, cy = 0;
 	double subx = 0, suby = 0;
-	std::vector<Segment> out;
+	Path out;
+	out.reserve(segments.size(), segments.paramsSize());
 	for(const auto &segment : segments) {
-		const auto &data = segment.data;
+		const auto data = segment.data;
 		switch(segment.key) {
 			case 'M':
-				out.emplace_back(Segment{ .key = 'M', .data = data });
+				out.append('M', data);
 				cx = data[0], cy = data[1];
 				subx = data[0], suby = data[1];
 				break;
 			case 'm':
 				cx += data[0];
 				cy += data[1];
-				out.emplace_back(Segment{ .key = 'M', .data = std::vector<double>{ cx, cy } });
+				out.append('M', { cx, cy });
 				subx = cx;
 				suby = cy;
 				break;
 			case 'L':
-				out.emplace_back(Segment{ .key = 'L', .data = data });
+				out.append('L', data);
 				cx = data[0], cy = data[1];
 				break;
 			case 'l':
 				cx += data[0];
 				cy += data[1];
-				out.emplace_back(Segment{ .key = 'L', .data = std::vector<double>{ cx, cy } });
+				out.append('L', { cx, cy });
 				break;
 			case 'C':
-				out.emplace_back(Segment{ .key = 'C', .data = data });
+				out.append('C', data);
 				cx = data[4];
 				cy = data[5];
 				break;
 			case 'c': {
-					const auto newdata = std::vector<double>{ data[0] + cx, data[1] + cy, data[2] + cx, data[3] + cy, data[4] + cx, data[5] + cy };
-					out.emplace_back(Segment{ .key = 'C', .data = newdata });
+					const std::array<double, 6> newdata{ data[0] + cx, data[1] + cy, data[2] + cx, data[3] + cy, data[4] + cx, data[5] + cy };
+					out.append('C', newdata);
 					cx = newdata[4];
 					cy = newdata[5];
 					break;
 				  }
 			case 'Q':
-				out.emplace_back(Segment{ .key = 'Q', .data = data });
+				out.append('Q', data);
 				cx = data[2];
 				cy = data[3];
 				break;
 			case 'q': {
-					const auto newdata = std::vector<double>{ data[0] + cx, data[1] + cy, data[2] + cx, data[3] + cy };
-					out.emplace_back(Segment{ .key = 'Q', .data = newdata });
+					const std::array<double, 4> newdata{ data[0] + cx, data[1] + cy, data[2] + cx, data[3] + cy };
+					out.append('Q', newdata);
 					cx = newdata[2];
 					cy = newdata[3];
 					break;
 				  }
 			case 'A':
-				out.emplace_back(Segment{ .key = 'A', .data = data });
+				out.append('A', data);
 				cx = data[5];
 				cy = data[6];
 				break;
 			case 'a':
 				cx += data[5];
 				cy += data[6];
-				out.emplace_back(Segment{ .key = 'A', .data = std::vector<double>{ data[0], data[1], data[2], data[3], data[4], cx, cy } });
+				out.append('A', { data[0], data[1], data[2], data[3], data[4], cx, cy });
 				break;
 			case 'H':
-				out.emplace_back(Segment{ .key = 'H', .data = data });
+				out.append('H', data);
 				cx = data[0];
 				break;
 			case 'h':
 				cx += data[0];
-				out.emplace_back(Segment{ .key = 'H', .data = std::vector<double>{ cx } });
+				out.append('H', { cx });
 				break;
 			case 'V':
-				out.emplace_back(Segment{ .key = 'V', .data = data });
+				out.append('V', data);
 				cy = data[0];
 				break;
 			case 'v':
 				cy += data[0];
-				out.emplace_back(Segment{ .key = 'V', .data = std::vector<double>{ cy } });
+				out.append('V', { cy });
 				break;
 			case 'S':
-				out.emplace_back(Segment{ .key = 'S', .data = data });
+				out.append('S', data);
 				cx = data[2];
 				cy = data[3];
 				break;
 			case 's': {
-					const auto newdata = std::vector<double>{ data[0] + cx, data[1] + cy, data[2] + cx, data[3] + cy };
-					out.emplace_back(Segment{ .key = 'S', .data = newdata });
+					const std::array<double, 4> newdata{ data[0] + cx, data[1] + cy, data[2] + cx, data[3] + cy };
+					out.append('S', newdata);
 					cx = newdata[2];
 					cy = newdata[3];
 					break;
 				  }
 			case 'T':
-				out.emplace_back(Segment{ .key = 'T', .data = data });
+				out.append('T', data);
 				cx = data[0];
 				cy = data[1];
 				break;
 			case 't':
 				cx += data[0];
 				cy += data[1];
-				out.emplace_back(Segment{ .key = 'T', .data = std::vector<double>{ cx, cy } });
+				out.append('T', { cx, cy });
 				break;
 			case 'Z':
 			case 'z':
-				out.emplace_back(Segment{ .key = 'Z', .data = std::vector<double>{ } });
+				out.append('Z', { });
 				cx = subx;
 				cy = suby;
 				break;
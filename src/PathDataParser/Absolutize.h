@@ -8,7 +8,7 @@
 namespace Rough {
 namespace PathDataParser {
 
-extern std::vector<Segment> absolutize(const std::vector<Segment> &segments);
+extern Path absolutize(const Path &segments);
 
 } /* PathDataParser */
 } /* Rough */
@@ -1,6 +1,7 @@
 #ifndef ROUGH_PATH_DATA_PARSER_NORMALIZE_H
 #define ROUGH_PATH_DATA_PARSER_NORMALIZE_H
 
+#include <array>
 #include <vector>
 
 #include "Parser.h"
@@ -8,7 +9,14 @@
 namespace Rough {
 namespace PathDataParser {
 
-extern std::vector<Segment> normalize(const std::vector<Segment> &segments);
+extern Path normalize(const Path &segments);
+
+// Control points and end point of a cubic curve
+typedef std::array<double, 6> CubicCurve;
+// Arcs are split into pieces of at most 120 degrees
+constexpr size_t MAX_ARC_CURVES = 4;
+
+extern size_t arcToCubicCurves(double x1, double y1, double x2, double y2, double r1, double r2, double angle, bool largeArcFlag, bool sweepFlag, std::array<CubicCurve, MAX_ARC_CURVES> &curves);
 
 } /* PathDataParser */
 } /* Rough */
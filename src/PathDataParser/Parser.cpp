@@ -1,95 +1,175 @@
 #include "Parser.h"
 
-#include <iterator>
-#include <map>
-#include <regex>
+#include <charconv>
 #include <stdexcept>
 
 namespace Rough {
 namespace PathDataParser {
- 
-std::vector<std::variant<char, double>> tokenize(const std::string &d)
-{
-	static const std::regex command("^([aAcChHlLmMqQsStTvVzZ])");
-	static const std::regex number("^(([-+]?[0-9]+(\\.[0-9]*)?|[-+]?\\.[0-9]+)([eE][-+]?[0-9]+)?)");
-	static const std::regex whitespace("^([\t\n\r ,]+)");
-
-	std::vector<std::variant<char, double>> tokens;
-	auto it = d.begin();
-
-	while(it != d.end()) {
-		std::smatch match;
-		if(std::regex_search(it, d.end(), match, command)) {
-			tokens.emplace_back(match[0].str().front());
-		} else if(std::regex_search(it, d.end(), match, number)) {
-			tokens.emplace_back(std::stod(match[0]));
-		} else if(std::regex_search(it, d.end(), match, whitespace)) {
-			// just skip whitespaces
-		} else {
-			return(std::vector<std::variant<char, double>>());
-		}
-
-		std::advance(it, match.length(1));
-	}
 
-	return tokens;
+static bool isDigit(char c)
+{
+	return c >= '0' && c <= '9';
 }
 
-static const std::map<char, size_t> PARAMS_COUNT { 
-	{ 'A', 7 }, { 'a', 7 }, { 'C', 6 }, { 'c', 6 }, { 'H', 1 }, { 'h', 1 }, 
-	{ 'L', 2 }, { 'l', 2 }, { 'M', 2 }, { 'm', 2 }, { 'Q', 4 }, { 'q', 4 },
-	{ 'S', 4 }, { 's', 4 }, { 'T', 2 }, { 't', 2 }, { 'V', 1 }, { 'v', 1 },
-	{ 'Z', 0 }, { 'z', 0 } 
-	};
+static bool isWhitespace(char c)
+{
+	return c == ' ' || c == ',' || c == '\t' || c == '\n' || c == '\r';
+}
 
-std::vector<Segment> parsePath(const std::string &d)
+Scanner::Scanner(std::string_view d, bool implicitMove)
+	: pos(d.data()), end(d.data() + d.size()), numberEnd(nullptr), mode('M'), started(false), hasFailed(false), implicitMove(implicitMove)
 {
-	std::vector<Segment> segments;
-	auto tokens = tokenize(d);
+}
 
-	if(tokens.empty()) {
-		return(segments);
+// Skips whitespaces and classifies the next token, for numbers the end is
+// remembered, so that readNumber() does not need to scan them again.
+// Numbers follow ([-+]?[0-9]+(\.[0-9]*)?|[-+]?\.[0-9]+)([eE][-+]?[0-9]+)?
+Scanner::Token Scanner::peek()
+{
+	while(pos != end && isWhitespace(*pos)) {
+		++pos;
+	}
+	if(pos == end) {
+		return Token::End;
+	}
+	if(isCommand(*pos)) {
+		return Token::Command;
 	}
 
-	char mode;
+	const char *p = pos;
+	if(*p == '+' || *p == '-') {
+		++p;
+	}
+	if(p != end && isDigit(*p)) {
+		while(p != end && isDigit(*p)) {
+			++p;
+		}
+		if(p != end && *p == '.') {
+			++p;
+			while(p != end && isDigit(*p)) {
+				++p;
+			}
+		}
+	} else if(p != end && *p == '.' && (p + 1) != end && isDigit(p[1])) {
+		p += 2;
+		while(p != end && isDigit(*p)) {
+			++p;
+		}
+	} else {
+		return Token::Invalid;
+	}
 
-	if(std::holds_alternative<double>(tokens.front()) || (std::get<char>(tokens.front()) != 'M' && std::get<char>(tokens.front()) != 'm')) {
-		segments.emplace_back(Segment{ .key = 'M', .data = { 0.0, 0.0 } });
-		mode = 'M';
+	if(p != end && (*p == 'e' || *p == 'E')) {
+		const char *exponent = p + 1;
+		if(exponent != end && (*exponent == '+' || *exponent == '-')) {
+			++exponent;
+		}
+		if(exponent != end && isDigit(*exponent)) {
+			while(exponent != end && isDigit(*exponent)) {
+				++exponent;
+			}
+			p = exponent;
+		}
 	}
-	
-	for(auto it = tokens.begin(); it != tokens.end(); ) {
-		std::vector<double> params;
-		size_t paramsCount = 0;
+	numberEnd = p;
+	return Token::Number;
+}
 
-		if(std::holds_alternative<char>(*it)) {
-			mode = std::get<char>(*it);
-			++it;
+bool Scanner::isWellFormed(std::string_view d)
+{
+	Scanner scanner(d);
+	for(Token token = scanner.peek(); token != Token::End; token = scanner.peek()) {
+		if(token == Token::Invalid) {
+			return false;
 		}
-		paramsCount = PARAMS_COUNT.at(mode);
+		scanner.pos = token == Token::Command ? scanner.pos + 1 : scanner.numberEnd;
+	}
+	return true;
+}
 
-		if(paramsCount <= (size_t) std::distance(it, tokens.end())) {
-			for(size_t i = 0; i < paramsCount && it != tokens.end(); ++it, i++) {
-				if(!std::holds_alternative<double>(*it)) {
-					throw std::invalid_argument("Param not a number: " + std::get<char>(*it));
-				}
+double Scanner::readNumber()
+{
+	// from_chars does not accept a leading plus
+	const char *first = *pos == '+' ? pos + 1 : pos;
+	double value = 0;
+	const auto result = std::from_chars(first, numberEnd, value);
+	if(result.ec == std::errc::result_out_of_range) {
+		throw std::out_of_range("Number out of range: " + std::string(pos, numberEnd));
+	}
+	pos = numberEnd;
+	return value;
+}
 
-				params.emplace_back(std::get<double>(*it));
-			}
+bool Scanner::next(char &key, std::array<double, MAX_PARAMS> &params)
+{
+	if(hasFailed) {
+		return false;
+	}
 
-			if(params.size() == PARAMS_COUNT.at(mode)) {
-				segments.emplace_back(Segment{  .key = mode, .data = params });
+	Token token = peek();
+	if(!started) {
+		started = true;
+		if((token == Token::Number && !implicitMove) || (token == Token::Command && *pos != 'M' && *pos != 'm')) {
+			// path data has to start with a move, assume the origin otherwise
+			key = 'M';
+			params[0] = params[1] = 0.0;
+			mode = 'M';
+			return true;
+		}
+	}
 
-				if(mode == 'M')
-					mode = 'L';
-				if(mode == 'm')
-					mode = 'l';
-			} else {
-				throw std::invalid_argument("Bad segment: " + mode);
-			}
-		} else {
+	if(token == Token::End) {
+		return false;
+	}
+	if(token == Token::Invalid) {
+		hasFailed = true;
+		return false;
+	}
+	if(token == Token::Command) {
+		mode = *pos++;
+	} else if(paramsCount(mode) == 0) {
+		throw std::invalid_argument(std::string("Bad segment: number after ") + mode);
+	}
+
+	const size_t count = paramsCount(mode);
+	for(size_t i = 0; i < count; i++) {
+		token = peek();
+		if(token == Token::End) {
 			throw std::invalid_argument("Path data ended short");
 		}
+		if(token == Token::Command) {
+			throw std::invalid_argument(std::string("Param not a number: ") + *pos);
+		}
+		if(token == Token::Invalid) {
+			hasFailed = true;
+			return false;
+		}
+		params[i] = readNumber();
+	}
+
+	key = mode;
+	if(mode == 'M') {
+		mode = 'L';
+	}
+	if(mode == 'm') {
+		mode = 'l';
+	}
+	return true;
+}
+
+Path parsePath(const std::string &d)
+{
+	Path segments;
+	Scanner scanner(d);
+	char key;
+	std::array<double, MAX_PARAMS> params;
+	while(scanner.next(key, params)) {
+		segments.append(key, params);
+	}
+
+	// like a broken token stream, invalid characters void the whole path
+	if(scanner.failed()) {
+		segments.clear();
 	}
 
 	return(segments);
@@ -1,23 +1,157 @@
 #ifndef ROUGH_PATH_DATA_PARSER_PARSER_H
 #define ROUGH_PATH_DATA_PARSER_PARSER_H
 
+#include <array>
+#include <cstdint>
+#include <initializer_list>
+#include <iterator>
+#include <span>
+#include <stdexcept>
 #include <string>
-#include <variant>
+#include <string_view>
 #include <vector>
 
 namespace Rough {
 namespace PathDataParser {
 
+// An arc has the most parameters of all commands
+constexpr size_t MAX_PARAMS = 7;
+constexpr uint8_t NO_COMMAND = 0xff;
+
+constexpr std::array<uint8_t, 128> PARAMS_COUNT = [] {
+	std::array<uint8_t, 128> table{};
+	table.fill(NO_COMMAND);
+	table['A'] = 7; table['a'] = 7; table['C'] = 6; table['c'] = 6;
+	table['H'] = 1; table['h'] = 1; table['L'] = 2; table['l'] = 2;
+	table['M'] = 2; table['m'] = 2; table['Q'] = 4; table['q'] = 4;
+	table['S'] = 4; table['s'] = 4; table['T'] = 2; table['t'] = 2;
+	table['V'] = 1; table['v'] = 1; table['Z'] = 0; table['z'] = 0;
+	return table;
+}();
+
+constexpr bool isCommand(char c)
+{
+	return static_cast<unsigned char>(c) < PARAMS_COUNT.size() && PARAMS_COUNT[static_cast<unsigned char>(c)] != NO_COMMAND;
+}
+
+constexpr size_t paramsCount(char key)
+{
+	return PARAMS_COUNT[static_cast<unsigned char>(key)];
+}
+
+// Reads the segments of a path one after another directly from the
+// d-attribute, without building a token list first. Malformed numbers or
+// unknown characters stop the scanner and mark it as failed, structural
+// errors (like missing parameters) throw std::invalid_argument.
+class Scanner
+{
+public:
+	// with implicitMove the data starts with the parameters of a move, like
+	// the points of a polygon, instead of a move to the origin
+	Scanner(std::string_view d, bool implicitMove = false);
+
+	bool next(char &key, std::array<double, MAX_PARAMS> &params);
+	bool failed() const { return hasFailed; }
+
+	// Checks only the characters, without converting numbers
+	static bool isWellFormed(std::string_view d);
+
+private:
+	enum class Token { End, Command, Number, Invalid };
+
+	Token peek();
+	double readNumber();
+
+	const char *pos;
+	const char *end;
+	const char *numberEnd;
+	char mode;
+	bool started;
+	bool hasFailed;
+	bool implicitMove;
+};
+
+// A single segment of a Path, the data points into the path's coordinates
 struct Segment
 {
 	char key;
-	std::vector<double> data;
+	std::span<const double> data;
 };
 
-extern std::vector<std::variant<char, double>> tokenize(const std::string &d);
-extern std::vector<Segment> parsePath(const std::string &d);
+// Path data packed into a byte per command and a single array holding the
+// parameters of all segments. The parameter count is given by the command,
+// thus no further bookkeeping per segment is needed.
+class Path
+{
+public:
+	class const_iterator
+	{
+	public:
+		using iterator_category = std::forward_iterator_tag;
+		using value_type = Segment;
+		using difference_type = std::ptrdiff_t;
+		using pointer = void;
+		using reference = Segment;
+
+		const_iterator() = default;
+		const_iterator(const char *key, const double *data)
+			: key(key), data(data)
+		{
+		}
+
+		Segment operator*() const { return Segment{ .key = *key, .data = std::span<const double>(data, paramsCount(*key)) }; }
+		const_iterator &operator++() { data += paramsCount(*key); ++key; return *this; }
+		const_iterator operator++(int) { const_iterator tmp = *this; ++*this; return tmp; }
+		bool operator==(const const_iterator &other) const { return key == other.key; }
+
+	private:
+		const char *key = nullptr;
+		const double *data = nullptr;
+	};
+
+	// throws std::invalid_argument for an unknown command or if data holds
+	// fewer parameters than the command takes
+	void append(char key, std::span<const double> data)
+	{
+		if(!isCommand(key) || data.size() < paramsCount(key)) {
+			throw std::invalid_argument(std::string("Bad segment: missing parameters for ") + key);
+		}
+		keys.push_back(key);
+		coords.insert(coords.end(), data.begin(), data.begin() + paramsCount(key));
+	}
+
+	void append(char key, std::initializer_list<double> data)
+	{
+		append(key, std::span<const double>(data.begin(), data.size()));
+	}
+
+	void reserve(size_t segments, size_t params)
+	{
+		keys.reserve(segments);
+		coords.reserve(params);
+	}
+
+	void clear()
+	{
+		keys.clear();
+		coords.clear();
+	}
+
+	size_t size() const { return keys.size(); }
+	bool empty() const { return keys.empty(); }
+	size_t paramsSize() const { return coords.size(); }
+
+	const_iterator begin() const { return const_iterator(keys.data(), coords.data()); }
+	const_iterator end() const { return const_iterator(keys.data() + keys.size(), coords.data() + coords.size()); }
+
+private:
+	std::vector<char> keys;
+	std::vector<double> coords;
+};
+
+extern Path parsePath(const std::string &d);
 
 } /* PathDataParser */
 } /* Rough */
- 
+
 #endif /* ROUGH_PATH_DATA_PARSER_PARSER_H */
@@ -0,0 +1,231 @@
+#include "Traverse.h"
+
+#include <array>
+#include <math.h>
+
+#include "Normalize.h"
+
+namespace Rough {
+namespace PathDataParser {
+
+class PathRecorder : public PathSink
+{
+public:
+	PathRecorder(Path &path)
+		: path(path)
+	{
+	}
+
+	virtual void moveTo(double x, double y)
+	{
+		path.append('M', { x, y });
+	}
+
+	virtual void lineTo(double x, double y)
+	{
+		path.append('L', { x, y });
+	}
+
+	virtual void bezierCurveTo(double x1, double y1, double x2, double y2, double x, double y)
+	{
+		path.append('C', { x1, y1, x2, y2, x, y });
+	}
+
+	virtual void closePath()
+	{
+		path.append('Z', {});
+	}
+
+private:
+	Path &path;
+};
+
+static bool traverse(std::string_view d, bool implicitMove, PathSink &sink)
+{
+	// the segment lists were dropped as a whole for invalid characters,
+	// thus don't emit anything before we know that all of them are valid
+	if(!Scanner::isWellFormed(d)) {
+		return false;
+	}
+
+	Scanner scanner(d, implicitMove);
+	char key;
+	std::array<double, MAX_PARAMS> data;
+	char lastType = 0x00;
+	double cx = 0, cy = 0;
+	double subx = 0, suby = 0;
+	double lcx = 0, lcy = 0;
+
+	while(scanner.next(key, data)) {
+		// absolutize
+		switch(key) {
+			case 'm':
+			case 'l':
+			case 't':
+				data[0] += cx;
+				data[1] += cy;
+				break;
+			case 'c':
+				data[4] += cx;
+				data[5] += cy;
+				[[fallthrough]];
+			case 'q':
+			case 's':
+				data[0] += cx;
+				data[1] += cy;
+				data[2] += cx;
+				data[3] += cy;
+				break;
+			case 'a':
+				data[5] += cx;
+				data[6] += cy;
+				break;
+			case 'h':
+				data[0] += cx;
+				break;
+			case 'v':
+				data[0] += cy;
+				break;
+		}
+		if(key >= 'a') {
+			key -= 'a' - 'A';
+		}
+
+		// normalize
+		switch(key) {
+			case 'M':
+				sink.moveTo(data[0], data[1]);
+				cx = data[0], cy = data[1];
+				subx = data[0], suby = data[1];
+				break;
+			case 'C':
+				sink.bezierCurveTo(data[0], data[1], data[2], data[3], data[4], data[5]);
+				cx = data[4];
+				cy = data[5];
+				lcx = data[2];
+				lcy = data[3];
+				break;
+			case 'L':
+				sink.lineTo(data[0], data[1]);
+				cx = data[0], cy = data[1];
+				break;
+			case 'H':
+				cx = data[0];
+				sink.lineTo(cx, cy);
+				break;
+			case 'V':
+				cy = data[0];
+				sink.lineTo(cx, cy);
+				break;
+			case 'S': {
+					  double cx1 = cx, cy1 = cy;
+					  if(lastType == 'C' || lastType == 'S') {
+						  cx1 = cx + (cx - lcx);
+						  cy1 = cy + (cy - lcy);
+					  }
+					  sink.bezierCurveTo(cx1, cy1, data[0], data[1], data[2], data[3]);
+					  lcx = data[0];
+					  lcy = data[1];
+					  cx = data[2];
+					  cy = data[3];
+					  break;
+				  }
+			case 'T': {
+					  const double x = data[0], y = data[1];
+					  double x1 = cx, y1 = cy;
+					  if(lastType == 'Q' || lastType == 'T') {
+						  x1 = cx + (cx - lcx);
+						  y1 = cy + (cy - lcy);
+					  }
+					  sink.bezierCurveTo(cx + 2 * (x1 - cx) / 3, cy + 2 * (y1 - cy) / 3, x + 2 * (x1 - x) / 3, y + 2 * (y1 - y) / 3, x, y);
+					  lcx = x1;
+					  lcy = y1;
+					  cx = x;
+					  cy = y;
+					  break;
+				  }
+			case 'Q': {
+					  const double x1 = data[0], y1 = data[1], x = data[2], y = data[3];
+					  sink.bezierCurveTo(cx + 2 * (x1 - cx) / 3, cy + 2 * (y1 - cy) / 3, x + 2 * (x1 - x) / 3, y + 2 * (y1 - y) / 3, x, y);
+					  lcx = x1;
+					  lcy = y1;
+					  cx = x;
+					  cy = y;
+					  break;
+				  }
+			case 'A': {
+					  const double r1 = abs(data[0]);
+					  const double r2 = abs(data[1]);
+					  const double x = data[5];
+					  const double y = data[6];
+					  if(r1 == 0 || r2 == 0) {
+						  sink.bezierCurveTo(cx, cy, x, y, x, y);
+						  cx = x;
+						  cy = y;
+					  } else if(cx != x || cy != y) {
+						  std::array<CubicCurve, MAX_ARC_CURVES> curves;
+						  const size_t count = arcToCubicCurves(cx, cy, x, y, r1, r2, data[2], data[3] > 0.5, data[4] > 0.5, curves);
+						  for(size_t i = 0; i < count; i++) {
+							  const CubicCurve &curve = curves[i];
+							  sink.bezierCurveTo(curve[0], curve[1], curve[2], curve[3], curve[4], curve[5]);
+						  }
+						  cx = x;
+						  cy = y;
+					  }
+					  break;
+				  }
+			case 'Z':
+				  sink.closePath();
+				  cx = subx;
+				  cy = suby;
+				  break;
+		}
+		lastType = key;
+	}
+	return !scanner.failed();
+}
+
+bool traversePath(std::string_view d, PathSink &sink)
+{
+	return traverse(d, false, sink);
+}
+
+void traversePath(const Path &normalized, PathSink &sink)
+{
+	for(const auto &segment : normalized) {
+		const auto data = segment.data;
+		switch(segment.key) {
+			case 'M':
+				sink.moveTo(data[0], data[1]);
+				break;
+			case 'L':
+				sink.lineTo(data[0], data[1]);
+				break;
+			case 'C':
+				sink.bezierCurveTo(data[0], data[1], data[2], data[3], data[4], data[5]);
+				break;
+			case 'Z':
+				sink.closePath();
+				break;
+		}
+	}
+}
+
+Path normalizedPath(std::string_view d)
+{
+	Path path;
+	PathRecorder recorder(path);
+	traversePath(d, recorder);
+	return path;
+}
+
+Path normalizedPoints(std::string_view points)
+{
+	Path path;
+	PathRecorder recorder(path);
+	traverse(points, true, recorder);
+	return path;
+}
+
+} /* PathDataParser */
+} /* Rough */
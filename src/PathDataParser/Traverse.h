@@ -0,0 +1,38 @@
+#ifndef ROUGH_PATH_DATA_PARSER_TRAVERSE_H
+#define ROUGH_PATH_DATA_PARSER_TRAVERSE_H
+
+#include <string_view>
+
+#include "Parser.h"
+
+namespace Rough {
+namespace PathDataParser {
+
+// Receives the segments of a path, already converted to absolute M, L, C and Z commands
+class PathSink
+{
+public:
+	virtual void moveTo(double x, double y) = 0;
+	virtual void lineTo(double x, double y) = 0;
+	virtual void bezierCurveTo(double x1, double y1, double x2, double y2, double x, double y) = 0;
+	virtual void closePath() = 0;
+};
+
+// Same as normalize(absolutize(parsePath(d))) but in a single pass without
+// any intermediate segment lists, returns false for malformed path data
+extern bool traversePath(std::string_view d, PathSink &sink);
+
+// Feeds an already normalized path into a sink
+extern void traversePath(const Path &normalized, PathSink &sink);
+
+// Parses path data directly into a normalized Path
+extern Path normalizedPath(std::string_view d);
+
+// Parses the points attribute of a polygon or polyline, a move to the first
+// point and lines to the others, the same as the path data "M " + points
+extern Path normalizedPoints(std::string_view points);
+
+} /* PathDataParser */
+} /* Rough */
+ 
+#endif /* ROUGH_PATH_DATA_PARSER_TRAVERSE_H */
@@ -1,30 +1,42 @@
 #include "PointsOnCurve.h"
 
 #include <algorithm>
+#include <array>
+#include <functional>
 #include <math.h>
+#include <utility>
 
 namespace Rough {
 namespace PointsOnCurve {
 
-static double distanceSq(Point p1, Point p2);
-static Point lerp(Point a, Point b, double t);
-static std::vector<Point> simplifyPoints(const std::vector<Point> &points, size_t start, size_t end, double epsilon);
-static std::vector<Point> simplifyPoints(const std::vector<Point> &points, size_t start, size_t end, double epsilon, std::vector<Point> &newPoints);
+template <class T> using CubicBezier = std::array<BasicPoint<T>, 4>;
+
+// Bounds the subdivision of degenerated curves, flatness shrinks by 16 per
+// level, so regular curves are flat long before.
+static constexpr size_t MAX_SUBDIVISION_DEPTH = 16;
+// Bounds the points of a single curve in the fixed count mode
+static constexpr size_t MAX_FIXED_SEGMENTS = 4096;
+
+template <class T> static double distanceSq(const BasicPoint<T> &p1, const BasicPoint<T> &p2);
+template <class T> static BasicPoint<T> lerp(const BasicPoint<T> &a, const BasicPoint<T> &b, double t);
 
 // distance between 2 points
-static double distance(Point p1, Point p2)
+template <class T>
+static double distance(const BasicPoint<T> &p1, const BasicPoint<T> &p2)
 {
 	return sqrt(distanceSq(p1, p2));
 }
 
 // distance between 2 points squared
-static double distanceSq(Point p1, Point p2)
+template <class T>
+static double distanceSq(const BasicPoint<T> &p1, const BasicPoint<T> &p2)
 {
 	return pow(p1[0] - p2[0], 2) + pow(p1[1] - p2[1], 2);
 }
 
 // Sistance squared from a point p to the line segment vw
-static double distanceToSegmentSq(Point p, Point v, Point w)
+template <class T>
+static double distanceToSegmentSq(const BasicPoint<T> &p, const BasicPoint<T> &v, const BasicPoint<T> &w)
 {
 	const double l2 = distanceSq(v, w);
 	if(l2 == 0) {
@@ -35,21 +47,20 @@ static double distanceToSegmentSq(Point p, Point v, Point w)
 	return distanceSq(p, lerp(v, w, t));
 }
 
-static Point lerp(Point a, Point b, double t)
+template <class T>
+static BasicPoint<T> lerp(const BasicPoint<T> &a, const BasicPoint<T> &b, double t)
 {
-	return Point{
+	return makePoint<T>({
 		a[0] + (b[0] - a[0]) * t,
-		a[1] + (b[1] - a[1]) * t,
-	};
+		a[1] + (b[1] - a[1]) * t
+	});
 }
 
 // Adapted from https://seant23.wordpress.com/2010/11/12/offset-bezier-curves/
-static double flatness(const std::vector<Point> &points, double offset)
+template <class T>
+static double flatness(const CubicBezier<T> &curve)
 {
-	const Point &p1 = points[offset + 0];
-	const Point &p2 = points[offset + 1];
-	const Point &p3 = points[offset + 2];
-	const Point &p4 = points[offset + 3];
+	const auto &[p1, p2, p3, p4] = curve;
 
 	double ux = 3 * p2[0] - 2 * p1[0] - p4[0]; ux *= ux;
 	double uy = 3 * p2[1] - 2 * p1[1] - p4[1]; uy *= uy;
@@ -67,101 +78,280 @@ static double flatness(const std::vector<Point> &points, double offset)
 	return ux + uy;
 }
 
-static std::vector<Point> getPointsOnBezierCurveWithSplitting(const std::vector<Point> &points, double offset, double tolerance, std::vector<Point> &newPoints)
+// Subdivides the curve until its parts are flat enough. The parts waiting
+// for their turn are kept on a fixed size stack, the left half is always
+// handled first, so the points come out in the same order as a recursive
+// subdivision would produce them. Duplicated points are only looked for
+// among the points appended after first.
+template <class T>
+static void getPointsOnBezierCurveWithSplitting(const CubicBezier<T> &curve, double tolerance, std::vector<BasicPoint<T>> &outPoints, size_t first)
 {
-	std::vector<Point> &outPoints = newPoints;
-	if(flatness(points, offset) < tolerance) {
-		const Point &p0 = points[offset + 0];
-		if(!outPoints.empty()) {
-			const double d = distance(outPoints.back(), p0);
-			if(d > 1) {
-				outPoints.push_back(p0);
+	struct PendingCurve
+	{
+		CubicBezier<T> curve;
+		size_t depth;
+	};
+	// every level leaves at most its right half on the stack
+	std::array<PendingCurve, MAX_SUBDIVISION_DEPTH + 1> stack;
+	size_t top = 0;
+	stack[top++] = PendingCurve{ curve, 0 };
+
+	while(top) {
+		const PendingCurve pending = stack[--top];
+		const auto &[p1, p2, p3, p4] = pending.curve;
+
+		// also stops at degenerated (NaN) curves, which are never flat
+		if(pending.depth >= MAX_SUBDIVISION_DEPTH || !(flatness(pending.curve) >= tolerance)) {
+			if(outPoints.size() > first) {
+				const double d = distance(outPoints.back(), p1);
+				if(d > 1) {
+					outPoints.push_back(p1);
+				}
+			} else {
+				outPoints.push_back(p1);
 			}
+			outPoints.push_back(p4);
 		} else {
-			outPoints.push_back(p0);
-		}
-		outPoints.push_back(points[offset + 3]);
-	} else {
-		// subdivide
-		const double t = .5;
-		const Point p1 = points[offset + 0];
-		const Point p2 = points[offset + 1];
-		const Point p3 = points[offset + 2];
-		const Point p4 = points[offset + 3];
+			// subdivide
+			const double t = .5;
 
-		const Point q1 = lerp(p1, p2, t);
-		const Point q2 = lerp(p2, p3, t);
-		const Point q3 = lerp(p3, p4, t);
+			const BasicPoint<T> q1 = lerp(p1, p2, t);
+			const BasicPoint<T> q2 = lerp(p2, p3, t);
+			const BasicPoint<T> q3 = lerp(p3, p4, t);
 
-		const Point r1 = lerp(q1, q2, t);
-		const Point r2 = lerp(q2, q3, t);
+			const BasicPoint<T> r1 = lerp(q1, q2, t);
+			const BasicPoint<T> r2 = lerp(q2, q3, t);
 
-		const Point red = lerp(r1, r2, t);
+			const BasicPoint<T> red = lerp(r1, r2, t);
 
-		getPointsOnBezierCurveWithSplitting(std::vector<Point>{p1, q1, r1, red}, 0, tolerance, outPoints);
-		getPointsOnBezierCurveWithSplitting(std::vector<Point>{red, r2, q3, p4}, 0, tolerance, outPoints);
+			stack[top++] = PendingCurve{ CubicBezier<T>{ red, r2, q3, p4 }, pending.depth + 1 };
+			stack[top++] = PendingCurve{ CubicBezier<T>{ p1, q1, r1, red }, pending.depth + 1 };
+		}
 	}
-	return outPoints;
 }
 
-std::vector<Point> simplify(const std::vector<Point> &points, double distance)
+// Ramer–Douglas–Peucker algorithm
+// https://en.wikipedia.org/wiki/Ramer%E2%80%93Douglas%E2%80%93Peucker_algorithm
+// The ranges still to be split are kept on a stack, the left one is handled
+// first, so the points are appended in their original order.
+template <class T>
+void simplify(std::span<const BasicPoint<T>> points, double epsilon, std::vector<BasicPoint<T>> &outPoints)
 {
-	return simplifyPoints(points, 0, points.size(), distance);
+	if(points.empty()) {
+		return;
+	}
+	const size_t first = outPoints.size();
+	const double epsilonSq = std::max(epsilon, 0.0) * std::max(epsilon, 0.0);
+
+	std::vector<std::pair<size_t, size_t>> ranges{ { 0, points.size() } };
+	while(!ranges.empty()) {
+		const auto [start, end] = ranges.back();
+		ranges.pop_back();
+
+		// find the most distance point from the endpoints
+		const BasicPoint<T> &s = points[start];
+		const BasicPoint<T> &e = points[end - 1];
+		double maxDistSq = 0;
+		size_t maxNdx = 1;
+		for(size_t i = start + 1; i < end - 1; ++i) {
+			const double distSq = distanceToSegmentSq(points[i], s, e);
+			if(distSq > maxDistSq) {
+				maxDistSq = distSq;
+				maxNdx = i;
+			}
+		}
+
+		// if that point is too far, split
+		if(maxDistSq > epsilonSq) {
+			ranges.emplace_back(maxNdx, end);
+			ranges.emplace_back(start, maxNdx + 1);
+		} else {
+			if(outPoints.size() == first) {
+				outPoints.push_back(s);
+			}
+			outPoints.push_back(e);
+		}
+	}
 }
 
-static std::vector<Point> simplifyPoints(const std::vector<Point> &points, size_t start, size_t end, double epsilon)
+template <class T>
+std::vector<BasicPoint<T>> simplify(const std::vector<BasicPoint<T>> &points, double distance)
 {
-	std::vector<Point> emptyNewPoints;
-	return simplifyPoints(points, start, end, epsilon, emptyNewPoints);
+	std::vector<BasicPoint<T>> outPoints;
+	simplify<T>(points, distance, outPoints);
+	return outPoints;
 }
 
-// Ramer–Douglas–Peucker algorithm
-// https://en.wikipedia.org/wiki/Ramer%E2%80%93Douglas%E2%80%93Peucker_algorithm
-static std::vector<Point> simplifyPoints(const std::vector<Point> &points, size_t start, size_t end, double epsilon, std::vector<Point> &newPoints)
+// Visvalingam–Whyatt algorithm
+// https://en.wikipedia.org/wiki/Visvalingam%E2%80%93Whyatt_algorithm
+// Removes the point spanning the smallest triangle with its neighbours
+// until only maxPoints are left. The areas are kept in a min-heap, entries
+// of points whose area changed meanwhile are skipped when popped.
+template <class T>
+void simplifyVisvalingam(std::span<const BasicPoint<T>> points, size_t maxPoints, std::vector<BasicPoint<T>> &outPoints)
 {
-	std::vector<Point> &outPoints = newPoints;
-
-	// find the most distance point from the endpoints
-	const Point s = points[start];
-	const Point e = points[end - 1];
-	double maxDistSq = 0;
-	size_t maxNdx = 1;
-	for(size_t i = start + 1; i < end - 1; ++i) {
-		const double distSq = distanceToSegmentSq(points[i], s, e);
-		if(distSq > maxDistSq) {
-			maxDistSq = distSq;
-			maxNdx = i;
+	const size_t count = points.size();
+	maxPoints = std::max<size_t>(maxPoints, 2);
+	if(count <= maxPoints) {
+		outPoints.insert(outPoints.end(), points.begin(), points.end());
+		return;
+	}
+
+	struct Candidate
+	{
+		double area;
+		size_t index;
+		bool operator>(const Candidate &other) const { return area > other.area; }
+	};
+
+	std::vector<size_t> prev(count), next(count);
+	std::vector<double> areas(count, INFINITY);
+	auto triangleArea = [&points](size_t a, size_t b, size_t c) -> double {
+		const BasicPoint<T> &pa = points[a], &pb = points[b], &pc = points[c];
+		return abs((pb[0] - pa[0]) * (pc[1] - pa[1]) - (pc[0] - pa[0]) * (pb[1] - pa[1])) / 2;
+	};
+
+	std::vector<Candidate> heap;
+	heap.reserve(count);
+	for(size_t i = 0; i < count; i++) {
+		prev[i] = i - 1;
+		next[i] = i + 1;
+		if(i > 0 && i + 1 < count) {
+			areas[i] = triangleArea(i - 1, i, i + 1);
+			heap.push_back(Candidate{ areas[i], i });
 		}
 	}
+	std::ranges::make_heap(heap, std::greater<>{});
 
-	// if that point is too far, split
-	if(sqrt(maxDistSq) > epsilon) {
-		simplifyPoints(points, start, maxNdx + 1, epsilon, outPoints);
-		simplifyPoints(points, maxNdx, end, epsilon, outPoints);
-	} else {
-		if(outPoints.empty()) {
-			outPoints.push_back(s);
+	size_t remaining = count;
+	while(remaining > maxPoints && !heap.empty()) {
+		std::ranges::pop_heap(heap, std::greater<>{});
+		const Candidate candidate = heap.back();
+		heap.pop_back();
+		if(candidate.area != areas[candidate.index]) {
+			continue;
+		}
+
+		const size_t i = candidate.index;
+		const size_t p = prev[i], n = next[i];
+		next[p] = n;
+		prev[n] = p;
+		areas[i] = -1;
+		remaining--;
+
+		// a neighbour never gets less important than the removed point
+		for(const size_t neighbour : { p, n }) {
+			if(neighbour > 0 && neighbour + 1 < count) {
+				areas[neighbour] = std::max(triangleArea(prev[neighbour], neighbour, next[neighbour]), candidate.area);
+				heap.push_back(Candidate{ areas[neighbour], neighbour });
+				std::ranges::push_heap(heap, std::greater<>{});
+			}
 		}
-		outPoints.push_back(e);
 	}
 
-	return outPoints;
+	outPoints.reserve(outPoints.size() + remaining);
+	for(size_t i = 0; i < count; i = next[i]) {
+		outPoints.push_back(points[i]);
+	}
+}
+
+// Wang's formula: the number of uniform steps after which the chords stay
+// within maxDistance of the curve, bounded by the control polygon
+template <class T>
+static size_t fixedSegmentCount(const CubicBezier<T> &curve, double maxDistance)
+{
+	const auto &[p1, p2, p3, p4] = curve;
+	const double ax = p1[0] - 2 * p2[0] + p3[0];
+	const double ay = p1[1] - 2 * p2[1] + p3[1];
+	const double bx = p2[0] - 2 * p3[0] + p4[0];
+	const double by = p2[1] - 2 * p3[1] + p4[1];
+	const double m = sqrt(std::max(ax * ax + ay * ay, bx * bx + by * by));
+	const double n = ceil(sqrt(0.75 * m / maxDistance));
+	// also catches NaN
+	return n >= 1 ? (size_t) std::min(n, (double) MAX_FIXED_SEGMENTS) : 1;
 }
 
-std::vector<Point> pointsOnBezierCurves(const std::vector<Point> &points, double tolerance, double distance)
+// Evaluates the curve at n uniform steps, the steps don't depend on each
+// other, which keeps the loop free of branches and easy to vectorize
+template <class T>
+static void getPointsOnBezierCurveWithFixedCount(const CubicBezier<T> &curve, size_t n, std::vector<BasicPoint<T>> &outPoints, size_t first)
 {
-	std::vector<Point> newPoints;
+	const auto &[p1, p2, p3, p4] = curve;
+	if(outPoints.size() == first || distance(outPoints.back(), p1) > 1) {
+		outPoints.push_back(p1);
+	}
+
+	// polynomial coefficients of the curve
+	const double ax = -p1[0] + 3 * p2[0] - 3 * p3[0] + p4[0];
+	const double ay = -p1[1] + 3 * p2[1] - 3 * p3[1] + p4[1];
+	const double bx = 3 * p1[0] - 6 * p2[0] + 3 * p3[0];
+	const double by = 3 * p1[1] - 6 * p2[1] + 3 * p3[1];
+	const double cx = 3 * (p2[0] - p1[0]);
+	const double cy = 3 * (p2[1] - p1[1]);
+
+	const size_t offset = outPoints.size();
+	outPoints.resize(offset + n);
+	BasicPoint<T> *out = outPoints.data() + offset;
+	const double step = 1.0 / n;
+	for(size_t i = 1; i < n; i++) {
+		const double t = i * step;
+		out[i - 1] = makePoint<T>({((ax * t + bx) * t + cx) * t + p1[0], ((ay * t + by) * t + cy) * t + p1[1]});
+	}
+	out[n - 1] = p4;
+}
+
+template <class T>
+void appendPointsOnBezierCurves(const std::vector<BasicPoint<T>> &points, double tolerance, CurveFlattening flattening, std::vector<BasicPoint<T>> &outPoints)
+{
+	const size_t first = outPoints.size();
 	const size_t numSegments = (points.size() - 1) / 3;
-	for(size_t i = 0; i < numSegments; i++) {
+	auto curveAt = [&points](size_t i) {
 		const size_t offset = i * 3;
-		getPointsOnBezierCurveWithSplitting(points, offset, tolerance, newPoints);
+		return CubicBezier<T>{ points[offset], points[offset + 1], points[offset + 2], points[offset + 3] };
+	};
+
+	if(flattening == CurveFlattening::FixedCount) {
+		// a flatness below tolerance bounds the distance to sqrt(tolerance) / 4
+		const double maxDistance = sqrt(tolerance) / 4;
+		size_t count = 0;
+		for(size_t i = 0; i < numSegments; i++) {
+			count += fixedSegmentCount(curveAt(i), maxDistance) + 1;
+		}
+		outPoints.reserve(first + count);
+		for(size_t i = 0; i < numSegments; i++) {
+			const CubicBezier<T> curve = curveAt(i);
+			getPointsOnBezierCurveWithFixedCount(curve, fixedSegmentCount(curve, maxDistance), outPoints, first);
+		}
+	} else {
+		outPoints.reserve(first + numSegments * 4);
+		for(size_t i = 0; i < numSegments; i++) {
+			getPointsOnBezierCurveWithSplitting(curveAt(i), tolerance, outPoints, first);
+		}
 	}
+}
+
+template <class T>
+std::vector<BasicPoint<T>> pointsOnBezierCurves(const std::vector<BasicPoint<T>> &points, double tolerance, double distance, CurveFlattening flattening)
+{
+	std::vector<BasicPoint<T>> newPoints;
+	appendPointsOnBezierCurves(points, tolerance, flattening, newPoints);
 	if(distance && distance > 0) {
-		return simplifyPoints(newPoints, 0, newPoints.size(), distance);
+		return simplify(newPoints, distance);
 	}
 	return newPoints;
 }
 
+template std::vector<BasicPoint<float>> pointsOnBezierCurves(const std::vector<BasicPoint<float>> &points, double tolerance, double distance, CurveFlattening flattening);
+template std::vector<BasicPoint<double>> pointsOnBezierCurves(const std::vector<BasicPoint<double>> &points, double tolerance, double distance, CurveFlattening flattening);
+template void appendPointsOnBezierCurves(const std::vector<BasicPoint<float>> &points, double tolerance, CurveFlattening flattening, std::vector<BasicPoint<float>> &outPoints);
+template void appendPointsOnBezierCurves(const std::vector<BasicPoint<double>> &points, double tolerance, CurveFlattening flattening, std::vector<BasicPoint<double>> &outPoints);
+template std::vector<BasicPoint<float>> simplify(const std::vector<BasicPoint<float>> &points, double distance);
+template std::vector<BasicPoint<double>> simplify(const std::vector<BasicPoint<double>> &points, double distance);
+template void simplify(std::span<const BasicPoint<float>> points, double distance, std::vector<BasicPoint<float>> &outPoints);
+template void simplify(std::span<const BasicPoint<double>> points, double distance, std::vector<BasicPoint<double>> &outPoints);
+template void simplifyVisvalingam(std::span<const BasicPoint<float>> points, size_t maxPoints, std::vector<BasicPoint<float>> &outPoints);
+template void simplifyVisvalingam(std::span<const BasicPoint<double>> points, size_t maxPoints, std::vector<BasicPoint<double>> &outPoints);
+
 } /* PointsOnCurve */
 } /* Rough */
  
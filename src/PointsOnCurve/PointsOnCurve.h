@@ -1,6 +1,7 @@
 #ifndef ROUGH_POINTS_ON_CURVE_H
 #define ROUGH_POINTS_ON_CURVE_H
 
+#include <span>
 #include <vector>
 #include <string>
 
@@ -9,8 +10,12 @@
 namespace Rough {
 namespace PointsOnCurve {
 
-extern std::vector<Point> pointsOnBezierCurves(const std::vector<Point> &points, double tolerance, double distance = 0.0);
-extern std::vector<Point> simplify(const std::vector<Point> &points, double distance);
+// instantiated for float and double points
+template <class T> std::vector<BasicPoint<T>> pointsOnBezierCurves(const std::vector<BasicPoint<T>> &points, double tolerance, double distance = 0.0, CurveFlattening flattening = CurveFlattening::Adaptive);
+template <class T> void appendPointsOnBezierCurves(const std::vector<BasicPoint<T>> &points, double tolerance, CurveFlattening flattening, std::vector<BasicPoint<T>> &outPoints);
+template <class T> std::vector<BasicPoint<T>> simplify(const std::vector<BasicPoint<T>> &points, double distance);
+template <class T> void simplify(std::span<const BasicPoint<T>> points, double distance, std::vector<BasicPoint<T>> &outPoints);
+template <class T> void simplifyVisvalingam(std::span<const BasicPoint<T>> points, size_t maxPoints, std::vector<BasicPoint<T>> &outPoints);
 
 } /* PointsOnCurve */
 } /* Rough */
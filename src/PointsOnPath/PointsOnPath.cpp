@@ -2,82 +2,151 @@
 
 #include <ranges>
 
-#include "../PathDataParser/Absolutize.h"
-#include "../PathDataParser/Normalize.h"
-#include "../PathDataParser/Parser.h"
+#include "../PathDataParser/Traverse.h"
 #include "../PointsOnCurve/PointsOnCurve.h"
 
 namespace Rough {
 namespace PointsOnPath {
 
-std::vector<std::vector<Point>> pointsOnPath(const std::string &path, double tolerance, double distance)
+class PointsSink : public PathDataParser::PathSink
 {
-	const std::vector<PathDataParser::Segment> segments = PathDataParser::parsePath(path);
-	const std::vector<PathDataParser::Segment> normalized = PathDataParser::normalize(PathDataParser::absolutize(segments));
+public:
+	PointsSink(double tolerance, CurveFlattening flattening)
+		: tolerance(tolerance), flattening(flattening), start{0, 0}
+	{
+	}
 
-	std::vector<std::vector<Point>> sets;
-	std::vector<Point> currentPoints;
-	Point start{0, 0};
-	std::vector<Point> pendingCurve;
+	virtual void moveTo(double x, double y)
+	{
+		appendPendingPoints();
+		start = makePoint({x, y});
+		rings.points.push_back(start);
+	}
+
+	virtual void lineTo(double x, double y)
+	{
+		appendPendingCurve();
+		rings.points.emplace_back(makePoint({x, y}));
+	}
+
+	virtual void bezierCurveTo(double x1, double y1, double x2, double y2, double x, double y)
+	{
+		if(pendingCurve.empty()) {
+			const Point lastPoint = currentRingEmpty() ? start : rings.points.back();
+			pendingCurve.emplace_back(lastPoint);
+		}
+		pendingCurve.emplace_back(makePoint({x1, y1}));
+		pendingCurve.emplace_back(makePoint({x2, y2}));
+		pendingCurve.emplace_back(makePoint({x, y}));
+	}
 
-	auto appendPendingCurve = [&]() {
+	virtual void closePath()
+	{
+		appendPendingCurve();
+		rings.points.push_back(start);
+	}
+
+	PointRings finish()
+	{
+		appendPendingPoints();
+		return std::move(rings);
+	}
+
+private:
+	bool currentRingEmpty() const
+	{
+		return rings.points.size() == rings.ringOffsets.back();
+	}
+
+	void appendPendingCurve()
+	{
 		if(pendingCurve.size() >= 4) {
-			auto pendingCurvePoints = PointsOnCurve::pointsOnBezierCurves(pendingCurve, tolerance);
-			std::copy(pendingCurvePoints.begin(), pendingCurvePoints.end(), std::back_inserter(currentPoints));
+			PointsOnCurve::appendPointsOnBezierCurves(pendingCurve, tolerance, flattening, rings.points);
 		}
 		pendingCurve.clear();
-	};
+	}
 
-	auto appendPendingPoints = [&]() {
+	void appendPendingPoints()
+	{
 		appendPendingCurve();
-		if(!currentPoints.empty()) {
-			sets.emplace_back(std::move(currentPoints));
-			currentPoints.clear();
-		}
-	};
-
-	for(const auto &segment : normalized) {
-		switch(segment.key) {
-			case 'M':
-				appendPendingPoints();
-				start = Point{segment.data[0], segment.data[1]};
-				currentPoints.push_back(start);
-				break;
-			case 'L':
-				appendPendingCurve();
-				currentPoints.emplace_back(Point{segment.data[0], segment.data[1]});
-				break;
-			case 'C':
-				if(pendingCurve.empty()) {
-					const Point lastPoint = currentPoints.size() ? currentPoints.back() : start;
-					pendingCurve.emplace_back(lastPoint);
-				}
-				pendingCurve.emplace_back(Point{segment.data[0], segment.data[1]});
-				pendingCurve.emplace_back(Point{segment.data[2], segment.data[3]});
-				pendingCurve.emplace_back(Point{segment.data[4], segment.data[5]});
-				break;
-			case 'Z':
-				appendPendingCurve();
-				currentPoints.push_back(start);
-				break;
+		if(!currentRingEmpty()) {
+			rings.ringOffsets.push_back(rings.points.size());
 		}
 	}
-	appendPendingPoints();
 
-	if(!distance) {
-		return sets;
+	const double tolerance;
+	const CurveFlattening flattening;
+	PointRings rings;
+	Point start;
+	std::vector<Point> pendingCurve;
+};
+
+// Without a point budget the rings are simplified to the given distance,
+// otherwise each ring is reduced to at most pointBudget points
+static PointRings simplifyRings(PointRings rings, double distance, size_t pointBudget)
+{
+	if(!distance && !pointBudget) {
+		return rings;
 	}
 
-	std::vector<std::vector<Point>> out;
-	for(const auto &set : sets) {
-		const auto simplifiedSet = PointsOnCurve::simplify(set, distance);
-		if(!simplifiedSet.empty()) {
-			out.emplace_back(simplifiedSet);
+	PointRings out;
+	out.points.reserve(rings.points.size());
+	out.ringOffsets.reserve(rings.ringOffsets.size());
+	std::vector<Point> simplified;
+	for(size_t i = 0; i < rings.size(); i++) {
+		// the budget only bounds what the distance leaves over, it never
+		// keeps more points than simplifying without a budget
+		if(!pointBudget) {
+			PointsOnCurve::simplify(rings.ring(i), distance, out.points);
+		} else if(!distance) {
+			PointsOnCurve::simplifyVisvalingam(rings.ring(i), pointBudget, out.points);
+		} else {
+			simplified.clear();
+			PointsOnCurve::simplify(rings.ring(i), distance, simplified);
+			PointsOnCurve::simplifyVisvalingam(std::span<const Point>(simplified), pointBudget, out.points);
+		}
+		if(out.points.size() != out.ringOffsets.back()) {
+			out.ringOffsets.push_back(out.points.size());
 		}
 	}
 	return out;
 }
 
+static std::vector<std::vector<Point>> toSets(const PointRings &rings)
+{
+	std::vector<std::vector<Point>> sets;
+	sets.reserve(rings.size());
+	for(size_t i = 0; i < rings.size(); i++) {
+		const auto ring = rings.ring(i);
+		sets.emplace_back(ring.begin(), ring.end());
+	}
+	return sets;
+}
+
+PointRings pointRingsOnPath(const std::string &path, double tolerance, double distance, CurveFlattening flattening, size_t pointBudget)
+{
+	PointsSink sink(tolerance, flattening);
+	PathDataParser::traversePath(path, sink);
+	return simplifyRings(sink.finish(), distance, pointBudget);
+}
+
+PointRings pointRingsOnPath(const PathDataParser::Path &normalized, double tolerance, double distance, CurveFlattening flattening, size_t pointBudget)
+{
+	PointsSink sink(tolerance, flattening);
+	PathDataParser::traversePath(normalized, sink);
+	return simplifyRings(sink.finish(), distance, pointBudget);
+}
+
+std::vector<std::vector<Point>> pointsOnPath(const std::string &path, double tolerance, double distance, CurveFlattening flattening, size_t pointBudget)
+{
+	return toSets(pointRingsOnPath(path, tolerance, distance, flattening, pointBudget));
+}
+
+std::vector<std::vector<Point>> pointsOnPath(const PathDataParser::Path &normalized, double tolerance, double distance, CurveFlattening flattening, size_t pointBudget)
+{
+	return toSets(pointRingsOnPath(normalized, tolerance, distance, flattening, pointBudget));
+}
+
 } /* PointsOnPath */
 } /* Rough */
  
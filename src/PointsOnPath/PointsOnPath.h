@@ -1,15 +1,36 @@
 #ifndef ROUGH_POINTS_ON_PATH_H
 #define ROUGH_POINTS_ON_PATH_H
 
+#include <span>
 #include <vector>
 #include <string>
 
 #include "../Core.h" // TODO: bad recursive dependency... but where else should this type be declared?
 
 namespace Rough {
+
+namespace PathDataParser {
+class Path;
+}
+
 namespace PointsOnPath {
 
-extern std::vector<std::vector<Point>> pointsOnPath(const std::string &path, double tolerance, double distance);
+// The points of all subpaths in a single array, ring i covers the points
+// from ringOffsets[i] up to ringOffsets[i + 1]
+struct PointRings
+{
+	std::vector<Point> points;
+	std::vector<size_t> ringOffsets{ 0 };
+
+	size_t size() const { return ringOffsets.size() - 1; }
+	bool empty() const { return ringOffsets.size() == 1; }
+	std::span<const Point> ring(size_t i) const { return std::span<const Point>(points).subspan(ringOffsets[i], ringOffsets[i + 1] - ringOffsets[i]); }
+};
+
+extern PointRings pointRingsOnPath(const std::string &path, double tolerance, double distance, CurveFlattening flattening = CurveFlattening::Adaptive, size_t pointBudget = 0);
+extern PointRings pointRingsOnPath(const PathDataParser::Path &normalized, double tolerance, double distance, CurveFlattening flattening = CurveFlattening::Adaptive, size_t pointBudget = 0);
+extern std::vector<std::vector<Point>> pointsOnPath(const std::string &path, double tolerance, double distance, CurveFlattening flattening = CurveFlattening::Adaptive, size_t pointBudget = 0);
+extern std::vector<std::vector<Point>> pointsOnPath(const PathDataParser::Path &normalized, double tolerance, double distance, CurveFlattening flattening = CurveFlattening::Adaptive, size_t pointBudget = 0);
 
 } /* PointsOnPath */
 } /* Rough */
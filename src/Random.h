@@ -0,0 +1,122 @@
+#ifndef ROUGH_RANDOM_H
+#define ROUGH_RANDOM_H
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <span>
+
+namespace Rough {
+
+// PCG32 (https://www.pcg-random.org), small and fast, the same seed always
+// yields the same sequence on every platform. It runs LANES independent
+// streams side by side, so that filling a block is a loop over the lanes
+// without dependencies between them.
+class Random
+{
+public:
+	static constexpr size_t LANES = 8;
+
+	Random(uint64_t seed)
+	{
+		for(size_t lane = 0; lane < LANES; lane++) {
+			state[lane] = 0;
+			increment[lane] = ((STREAM + lane) << 1u) | 1u;
+		}
+		step();
+		for(size_t lane = 0; lane < LANES; lane++) {
+			state[lane] += seed;
+		}
+		step();
+	}
+
+	// Fills out with numbers uniformly distributed in [0, 1), the size has
+	// to be a multiple of LANES
+	void fill(std::span<double> out)
+	{
+		for(size_t i = 0; i + LANES <= out.size(); i += LANES) {
+			for(size_t lane = 0; lane < LANES; lane++) {
+				const uint64_t old = state[lane];
+				const uint32_t xorshifted = ((old >> 18u) ^ old) >> 27u;
+				const uint32_t rot = old >> 59u;
+				out[i + lane] = ((xorshifted >> rot) | (xorshifted << ((-rot) & 31))) * (1.0 / 4294967296.0);
+			}
+			step();
+		}
+	}
+
+private:
+	static constexpr uint64_t STREAM = 54;
+
+	void step()
+	{
+		for(size_t lane = 0; lane < LANES; lane++) {
+			state[lane] = state[lane] * 6364136223846793005ULL + increment[lane];
+		}
+	}
+
+	std::array<uint64_t, LANES> state;
+	std::array<uint64_t, LANES> increment;
+};
+
+// Random numbers of a seed, generated a block at a time and refilled when
+// the block is used up. Seed 0 stands for rand(), the block then holds the
+// numbers rand() would have returned one by one.
+class RandomBlock
+{
+public:
+	static constexpr size_t SIZE = 32 * Random::LANES;
+
+	RandomBlock(uint64_t seed)
+		: randomSeed(seed), random(seed), used(SIZE)
+	{
+	}
+
+	uint64_t seed() const { return randomSeed; }
+
+	double next()
+	{
+		if(used == SIZE) {
+			refill();
+		}
+		return values[used++];
+	}
+
+	// the next out.size() numbers, the same as calling next() for each
+	void next(std::span<double> out)
+	{
+		for(size_t i = 0; i < out.size();) {
+			if(used == SIZE) {
+				refill();
+			}
+			const size_t count = std::min(SIZE - used, out.size() - i);
+			std::copy_n(values.begin() + used, count, out.begin() + i);
+			used += count;
+			i += count;
+		}
+	}
+
+private:
+	void refill()
+	{
+		if(randomSeed) {
+			random.fill(values);
+		} else {
+			for(double &value : values) {
+				value = (rand() % (10000)) / 10000.0;
+			}
+		}
+		used = 0;
+	}
+
+	uint64_t randomSeed;
+	Random random;
+	std::array<double, SIZE> values;
+	size_t used;
+};
+
+} /* namespace Rough */
+
+#endif /* ROUGH_RANDOM_H */
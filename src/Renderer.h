@@ -3,32 +3,43 @@
 
 #include <vector>
 #include <optional>
+#include <span>
 #include <string>
 
 #include "Core.h"
+#include "Graphics.h"
+#include "OpSet.h"
+#include "Random.h"
 
 namespace Rough {
 
-class Graphics
-{
-public:
-	virtual void moveTo(double x, double y) = 0;
-	virtual void lineTo(double x, double y) = 0;
-	virtual void bezierCurveTo(double x1, double y1, double x2, double y2, double x3, double y3) = 0;
-};
+namespace PathDataParser {
+class Path;
+}
+
+namespace PointsOnPath {
+struct PointRings;
+}
 
 struct EllipseParams
 {
 	double increment;
 	double rx;
 	double ry;
+	// the larger side of the bounding box before the radii are jittered,
+	// all level of detail decisions for the ellipse are made from it
+	double extent;
 };
 
-class Renderer
+// Sketches shapes into a sink, it is instantiated for OpSet and for the
+// virtual Graphics. The definitions are in Renderer.inl, other sinks
+// include it to instantiate the renderer and its fillers for themselves.
+template <GraphicsSink Sink>
+class BasicRenderer
 {
 public:
-	Renderer(Graphics &graphics)
-		: graphics(graphics)
+	BasicRenderer(Sink &sink)
+		: sink(sink)
 	{
 	}
 
@@ -42,17 +53,45 @@ public:
 	std::vector<Point> ellipseWithParams(double x, double y, const RoughOptions o, const EllipseParams &ellipseParams);
 	void arc(double x, double y, double width, double height, double start, double stop, bool closed, bool roughClosure, const RoughOptions &o);
 	void svgPath(const std::string &path, const RoughOptions &o);
+	void svgPath(const PathDataParser::Path &normalized, const RoughOptions &o);
 	void solidFillPolygon(std::vector<Point> points, const RoughOptions &o);
-	void patternFillPolygon(std::vector<Point> points, const RoughOptions &o);
+	void patternFillPolygon(std::span<const Point> points, const RoughOptions &o);
+	// the rings filled as one polygon, small ones are outlined ring by ring
+	void patternFillPolygon(const PointsOnPath::PointRings &rings, const RoughOptions &o);
 	void patternFillArc(double x, double y, double width, double height, double start, double stop, const RoughOptions &o);
 	// randOffset()
 	// randOffsetWithRange()
 	void doubleLineFillOps(double x1, double y1, double x2, double y2, const RoughOptions &o);
+	void polylineFillOps(std::span<const Point> points, const RoughOptions &o);
+	// doubleLineFillOps() for each line, computed for batches of lines at once
+	void linesFillOps(std::span<const Line> lines, const RoughOptions &o);
 
 	void fillPath(const std::string &path, const RoughOptions &o);
+
+	// the number of shapes drawn with less detail, see RoughOptions::lodStrokeExtent
+	size_t downgradedStrokes() const { return downgradedStrokeCount; }
+	size_t downgradedFills() const { return downgradedFillCount; }
+
+	// a random number between 0 and 1, also used by the fillers, drawn
+	// from the generator of o.seed or from rand() if there is no seed
+	double randomWithOptions(const RoughOptions &options)
+	{
+		if(!currentRandom || currentRandom->seed() != options.seed) {
+			currentRandom = &randomForSeed(options.seed);
+		}
+		return currentRandom->next();
+	}
+
 private:
+	class SvgPathSink;
+
 	RoughOptions cloneOptionsAlterSeed(const RoughOptions &options);
-	double randomWithOptions(const RoughOptions &options);
+	// o without the second stroke if a shape of that extent (the larger side
+	// of its bounding box) is below o.lodStrokeExtent
+	RoughOptions strokeDetail(double extent, const RoughOptions &o);
+	RandomBlock &randomForSeed(uint64_t seed);
+	// the next out.size() numbers randomWithOptions() would return
+	void randomsWithOptions(std::span<double> out, const RoughOptions &options);
 	double offset(double min, double max, const RoughOptions &o, double roughnessGain = 1.0);
 	double offsetOpt(double x, const RoughOptions &o, double roughnessGain = 1.0);
 	void doubleLine(double x1, double y1, double x2, double y2, const RoughOptions &o, bool filling  = false);
@@ -62,10 +101,25 @@ private:
 	std::tuple<std::vector<Point>, std::vector<Point>> computeEllipsePoints(double increment, double cx, double cy, double rx, double ry, double offset, double overlap, const RoughOptions &o);
 	void privateArc(double increment, double cx, double cy, double rx, double ry, double strt, double stp, double offset, const RoughOptions &o);
 	void bezierTo(double x1, double y1, double x2, double y2, double x, double y, Point current, const RoughOptions &o);
+	void patternFill(std::span<const Point> points, const RoughOptions &o);
+	// the single stroke around a ring filling it if it is too small for a pattern
+	void outlineFill(std::span<const Point> ring, const RoughOptions &o);
 
-	Graphics &graphics;
+	Sink &sink;
+	// the numbers of each seed in use, usually just the seed of the options
+	// and the one altered by cloneOptionsAlterSeed()
+	std::vector<RandomBlock> randoms;
+	RandomBlock *currentRandom = nullptr;
+	size_t downgradedStrokeCount = 0;
+	size_t downgradedFillCount = 0;
 };
 
+extern template class BasicRenderer<OpSet>;
+extern template class BasicRenderer<Graphics>;
+
+// the renderer of sketchify, recording all ops
+using Renderer = BasicRenderer<OpSet>;
+
 }
 
 #endif /* ROUGH_RENDERER_H */
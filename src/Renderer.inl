@@ -0,0 +1,735 @@
+#ifndef ROUGH_RENDERER_INL
+#define ROUGH_RENDERER_INL
+
+#include "Renderer.h"
+
+#include <array>
+#include <math.h>
+
+#include "Geometry.h"
+#include "fillers/HachureFiller.inl"
+#include "fillers/DotFiller.inl"
+#include "fillers/HatchFiller.inl"
+#include "PathDataParser/Traverse.h"
+
+#include "PointsOnPath/PointsOnPath.h"
+
+namespace Rough
+{
+
+// the fewest steps of an ellipse drawn with less detail
+inline constexpr double LOD_ELLIPSE_STEP_COUNT = 5;
+
+// the larger side of the bounding box of points
+inline double extentOf(std::span<const Point> points)
+{
+	if(points.empty()) {
+		return 0;
+	}
+	double minX = points[0][0], maxX = points[0][0];
+	double minY = points[0][1], maxY = points[0][1];
+	for(const Point &p : points) {
+		minX = std::min<double>(minX, p[0]);
+		maxX = std::max<double>(maxX, p[0]);
+		minY = std::min<double>(minY, p[1]);
+		maxY = std::max<double>(maxY, p[1]);
+	}
+	return std::max(maxX - minX, maxY - minY);
+}
+
+// the same for the end and control points of a normalized path
+inline double extentOf(const PathDataParser::Path &normalized)
+{
+	double minX = INFINITY, maxX = -INFINITY;
+	double minY = INFINITY, maxY = -INFINITY;
+	for(const auto &segment : normalized) {
+		for(size_t i = 0; i + 1 < segment.data.size(); i += 2) {
+			minX = std::min(minX, segment.data[i]);
+			maxX = std::max(maxX, segment.data[i]);
+			minY = std::min(minY, segment.data[i + 1]);
+			maxY = std::max(maxY, segment.data[i + 1]);
+		}
+	}
+	return minX <= maxX ? std::max(maxX - minX, maxY - minY) : 0;
+}
+
+template <GraphicsSink Sink>
+void BasicRenderer<Sink>::line(double x1, double y1, double x2, double y2, const RoughOptions &o)
+{
+	doubleLine(x1, y1, x2, y2, strokeDetail(std::max(fabs(x2 - x1), fabs(y2 - y1)), o));
+}
+
+template <GraphicsSink Sink>
+void BasicRenderer<Sink>::linearPath(const std::vector<Point> &points, bool close, const RoughOptions &options)
+{
+	const RoughOptions o = strokeDetail(extentOf(points), options);
+	const double len = points.size();
+	if(len > 2) {
+		for(size_t i = 0; i < (len - 1); i++) {
+			doubleLine(points[i][0], points[i][1], points[i + 1][0], points[i + 1][1], o);
+		}
+		if(close) {
+			doubleLine(points[len - 1][0], points[len - 1][1], points[0][0], points[0][1], o);
+		}
+	} else if(len == 2) {
+		doubleLine(points[0][0], points[0][1], points[1][0], points[1][1], o);
+	}
+}
+
+template <GraphicsSink Sink>
+void BasicRenderer<Sink>::polygon(const std::vector<Point> &points, const RoughOptions &o)
+{
+	linearPath(points, true, o);
+}
+
+template <GraphicsSink Sink>
+void BasicRenderer<Sink>::rectangle(double x, double y, double width, double height, const RoughOptions &o)
+{
+	std::vector<Point> points{
+		makePoint({x, y}),
+		makePoint({x + width, y}),
+		makePoint({x + width, y + height}),
+		makePoint({x, y + height})
+	};
+	return polygon(points, o);
+}
+
+template <GraphicsSink Sink>
+void BasicRenderer<Sink>::curve(const std::vector<Point> &points, const RoughOptions &options)
+{
+	const RoughOptions o = strokeDetail(extentOf(points), options);
+	curveWithOffset(points, 1 * (1 + o.roughness * 0.2), o);
+	if(!o.disableMultiStroke) {
+		curveWithOffset(points, 1.5 * (1 + o.roughness * 0.22), cloneOptionsAlterSeed(o));
+	}
+}
+
+template <GraphicsSink Sink>
+void BasicRenderer<Sink>::ellipse(double x, double y, double width, double height, const RoughOptions &o)
+{
+	const auto params = generateEllipseParams(width, height, o);
+	ellipseWithParams(x, y, o, params);
+}
+
+template <GraphicsSink Sink>
+EllipseParams BasicRenderer<Sink>::generateEllipseParams(double width, double height, const RoughOptions &o)
+{
+	const double psq = sqrt(M_PI * 2 * sqrt(((width / 2) * (width / 2) + (height / 2) * (height / 2)) / 2));
+	double stepCount = std::max(o.curveStepCount, (o.curveStepCount / sqrt(200)) * psq);
+	const double extent = std::max(fabs(width), fabs(height));
+	if(extent < o.lodStrokeExtent) {
+		stepCount = std::max(LOD_ELLIPSE_STEP_COUNT, o.curveStepCount * extent / o.lodStrokeExtent);
+	}
+	const double increment = (M_PI * 2) / stepCount;
+	double rx = abs(width / 2);
+	double ry = abs(height / 2);
+	const double curveFitRandomness = 1 - o.curveFitting;
+	rx += offsetOpt(rx * curveFitRandomness, o);
+	ry += offsetOpt(ry * curveFitRandomness, o);
+	return EllipseParams{ increment, rx, ry, extent };
+}
+
+template <GraphicsSink Sink>
+std::vector<Point> BasicRenderer<Sink>::ellipseWithParams(double x, double y, const RoughOptions options, const EllipseParams &ellipseParams)
+{
+	const RoughOptions o = strokeDetail(ellipseParams.extent, options);
+	const auto [ap1, cp1] = computeEllipsePoints(ellipseParams.increment, x, y, ellipseParams.rx, ellipseParams.ry, 1.0, ellipseParams.increment * offset(0.1, offset(0.4, 1.0, o), o), o);
+	curve(ap1, std::nullopt, o);
+	if(!o.disableMultiStroke) {
+		const auto [ap2, cp1] = computeEllipsePoints(ellipseParams.increment, x, y, ellipseParams.rx, ellipseParams.ry, 1.5, 0, o);
+		curve(ap2, std::nullopt, o);
+	}
+
+	return(cp1);
+}
+
+template <GraphicsSink Sink>
+void BasicRenderer<Sink>::arc(double x, double y, double width, double height, double start, double stop, bool closed, bool roughClosure, const RoughOptions &options)
+{
+	const RoughOptions o = strokeDetail(std::max(fabs(width), fabs(height)), options);
+	const double cx = x;
+	const double cy = y;
+	double rx = abs(width / 2);
+	double ry = abs(height / 2);
+	rx += offsetOpt(rx * 0.01, o);
+	ry += offsetOpt(ry * 0.01, o);
+	double strt = start;
+	double stp = stop;
+	while(strt < 0) {
+		strt += M_PI * 2;
+		stp += M_PI * 2;
+	}
+	if((stp - strt) > (M_PI * 2)) {
+		strt = 0;
+		stp = M_PI * 2;
+	}
+	const double ellipseInc = (M_PI * 2) / o.curveStepCount;
+	const double arcInc = std::min(ellipseInc / 2, (stp - strt) / 2);
+	privateArc(arcInc, cx, cy, rx, ry, strt, stp, 1, o);
+	if(!o.disableMultiStroke) {
+		privateArc(arcInc, cx, cy, rx, ry, strt, stp, 1.5, o);
+	}
+	if(closed) {
+		if(roughClosure) {
+			doubleLine(cx, cy, cx + rx * cos(strt), cy + ry * sin(strt), o);
+			doubleLine(cx, cy, cx + rx * cos(stp), cy + ry * sin(stp), o);
+		} else {
+			sink.lineTo(cx, cy);
+			sink.lineTo(cx + rx * cos(strt), cy + ry * sin(strt));
+		}
+	}
+}
+
+template <GraphicsSink Sink>
+class BasicRenderer<Sink>::SvgPathSink : public PathDataParser::PathSink
+{
+public:
+	SvgPathSink(BasicRenderer &renderer, const RoughOptions &o)
+		: renderer(renderer), o(o), first{0, 0}, current{0, 0}
+	{
+	}
+
+	virtual void moveTo(double x, double y)
+	{
+		const double ro = 1 * o.maxRandomnessOffset;
+		// drawn in a fixed order, see privateLine()
+		const double offsetY = renderer.offsetOpt(ro, o);
+		const double offsetX = renderer.offsetOpt(ro, o);
+		renderer.sink.moveTo(x + offsetX, y + offsetY);
+		current = makePoint({x, y});
+		first = makePoint({x, y});
+	}
+
+	virtual void lineTo(double x, double y)
+	{
+		renderer.doubleLine(current[0], current[1], x, y, o);
+		current = makePoint({x, y});
+	}
+
+	virtual void bezierCurveTo(double x1, double y1, double x2, double y2, double x, double y)
+	{
+		renderer.bezierTo(x1, y1, x2, y2, x, y, current, o);
+		current = makePoint({x, y});
+	}
+
+	virtual void closePath()
+	{
+		renderer.doubleLine(current[0], current[1], first[0], first[1], o);
+		current = Point{first[0], first[1]};
+	}
+
+private:
+	BasicRenderer &renderer;
+	const RoughOptions &o;
+	Point first;
+	Point current;
+};
+
+template <GraphicsSink Sink>
+void BasicRenderer<Sink>::svgPath(const std::string &path, const RoughOptions &o)
+{
+	svgPath(PathDataParser::normalizedPath(path), o);
+}
+
+template <GraphicsSink Sink>
+void BasicRenderer<Sink>::svgPath(const PathDataParser::Path &normalized, const RoughOptions &options)
+{
+	const RoughOptions o = strokeDetail(extentOf(normalized), options);
+	SvgPathSink sink(*this, o);
+	PathDataParser::traversePath(normalized, sink);
+}
+
+/*
+ * svgPath()
+ */
+template <GraphicsSink Sink>
+void BasicRenderer<Sink>::solidFillPolygon(std::vector<Point> points, const RoughOptions &o)
+{
+	if(points.size()) {
+		const double offset = o.maxRandomnessOffset;
+		const size_t len = points.size();
+		if(len > 2) {
+			// drawn in a fixed order, see privateLine()
+			const double moveY = offsetOpt(offset, o);
+			const double moveX = offsetOpt(offset, o);
+			sink.moveTo(points[0][0] + moveX, points[0][1] + moveY);
+			for(size_t i = 1; i < len; i++) {
+				const double offsetY = offsetOpt(offset, o);
+				const double offsetX = offsetOpt(offset, o);
+				sink.lineTo(points[i][0] + offsetX, points[i][1] + offsetY);
+			}
+		}
+	}
+	// TODO: fill?
+}
+
+/*
+ * patternFillPolygon()
+ */
+template <GraphicsSink Sink>
+void BasicRenderer<Sink>::patternFillPolygon(std::span<const Point> points, const RoughOptions &o)
+{
+	if(!points.empty() && extentOf(points) < o.lodFillExtent) {
+		outlineFill(points, o);
+		downgradedFillCount++;
+		return;
+	}
+	patternFill(points, o);
+}
+
+template <GraphicsSink Sink>
+void BasicRenderer<Sink>::patternFillPolygon(const PointsOnPath::PointRings &rings, const RoughOptions &o)
+{
+	if(!rings.points.empty() && extentOf(rings.points) < o.lodFillExtent) {
+		// a stroke connecting the rings would cross the holes between them
+		for(size_t i = 0; i < rings.size(); i++) {
+			outlineFill(rings.ring(i), o);
+		}
+		downgradedFillCount++;
+		return;
+	}
+	patternFill(rings.points, o);
+}
+
+template <GraphicsSink Sink>
+void BasicRenderer<Sink>::patternFill(std::span<const Point> points, const RoughOptions &o)
+{
+	switch(o.fillStyle) {
+		case FillStyle::ZigZag: {
+			Filler::HachureFiller<Sink> filler(*this);
+			filler.fillPolygon(points, o, true);
+			break;
+		}
+		case FillStyle::Dots: {
+			Filler::DotFiller<Sink> filler(*this);
+			filler.fillPolygon(points, o);
+			break;
+		}
+		case FillStyle::CrossHatch: {
+			Filler::HatchFiller<Sink> filler(*this);
+			filler.fillPolygon(points, o);
+			break;
+		}
+		default: {
+			Filler::HachureFiller<Sink> filler(*this);
+			filler.fillPolygon(points, o);
+			break;
+		}
+	}
+}
+
+template <GraphicsSink Sink>
+void BasicRenderer<Sink>::outlineFill(std::span<const Point> ring, const RoughOptions &o)
+{
+	if(ring.empty()) {
+		return;
+	}
+	std::vector<Point> outline(ring.begin(), ring.end());
+	if(ring.back() != ring.front()) {
+		outline.push_back(ring.front());
+	}
+	RoughOptions single{ o };
+	single.disableMultiStrokeFill = true;
+	polylineFillOps(outline, single);
+}
+
+template <GraphicsSink Sink>
+void BasicRenderer<Sink>::patternFillArc(double x, double y, double width, double height, double start, double stop, const RoughOptions &o)
+{
+	const double cx = x;
+	const double cy = y;
+	double rx = abs(width / 2);
+	double ry = abs(height / 2);
+	rx += offsetOpt(rx * 0.01, o);
+	ry += offsetOpt(ry * 0.01, o);
+	double strt = start;
+	double stp = stop;
+	while(strt < 0) {
+		strt += M_PI * 2;
+		stp += M_PI * 2;
+	}
+	if((stp - strt) > (M_PI * 2)) {
+		strt = 0;
+		stp = M_PI * 2;
+	}
+	const double increment = (stp - strt) / o.curveStepCount;
+	std::vector<Point> points;
+	Geometry::AngleSteps step(Geometry::UnitVector::of(strt), Geometry::UnitVector::of(increment));
+	for(double angle = strt; angle <= stp; angle = angle + increment, ++step) {
+		points.emplace_back(makePoint({cx + rx * step->cosine, cy + ry * step->sine}));
+	}
+	const auto end = Geometry::UnitVector::of(stp);
+	points.emplace_back(makePoint({cx + rx * end.cosine, cy + ry * end.sine}));
+	points.emplace_back(makePoint({cx, cy}));
+
+	patternFillPolygon(points, o);
+}
+
+/*
+ * randOffset()
+ * randOffsetWithRange()
+ * doubleLineFillOps()
+ */
+template <GraphicsSink Sink>
+void BasicRenderer<Sink>::doubleLineFillOps(double x1, double y1, double x2, double y2, const RoughOptions &o)
+{
+	doubleLine(x1, y1, x2, y2, o, true);
+}
+
+// Like doubleLineFillOps() for each segment, but every stroke is a single
+// move followed by one curve per segment
+template <GraphicsSink Sink>
+void BasicRenderer<Sink>::polylineFillOps(std::span<const Point> points, const RoughOptions &o)
+{
+	if(points.size() < 2) {
+		return;
+	}
+	for(int stroke = 0; stroke < (o.disableMultiStrokeFill ? 1 : 2); stroke++) {
+		for(size_t i = 1; i < points.size(); i++) {
+			privateLine(points[i - 1][0], points[i - 1][1], points[i][0], points[i][1], o, i == 1, stroke > 0);
+		}
+	}
+}
+template <GraphicsSink Sink>
+void BasicRenderer<Sink>::linesFillOps(std::span<const Line> lines, const RoughOptions &o)
+{
+	// the random numbers of a stroke in the order privateLine() draws them
+	enum { DIVERGE, MID_DISP_X, MID_DISP_Y, MOVE_Y, MOVE_X, END_Y, END_X, CONTROL2_Y, CONTROL2_X, CONTROL1_Y, CONTROL1_X, RANDOMS_PER_STROKE };
+	// the coordinates of a stroke, in the order of moveTo() and bezierCurveTo()
+	enum { MOVE_TO_X, MOVE_TO_Y, CURVE_X1, CURVE_Y1, CURVE_X2, CURVE_Y2, CURVE_X, CURVE_Y, COORDINATES_PER_STROKE };
+	constexpr size_t BATCH = 64;
+	const size_t strokes = o.disableMultiStrokeFill ? 1 : 2;
+	const size_t randomsPerLine = strokes * RANDOMS_PER_STROKE;
+	const auto jitter = [&o](double random, double x, double roughnessGain) {
+		return o.roughness * roughnessGain * ((random * (x - -x)) + -x);
+	};
+
+	// The coordinates are truncated to int like the parameters of
+	// privateLine(). The random numbers are drawn line by line and then
+	// stored per stroke and field, like the coordinates, so that the loops
+	// over the lines of a batch run over contiguous arrays.
+	std::array<double, BATCH> x1, y1, x2, y2, roughnessGain, offset;
+	std::array<double, BATCH * 2 * RANDOMS_PER_STROKE> drawn;
+	std::array<std::array<double, BATCH>, 2 * RANDOMS_PER_STROKE> randoms;
+	std::array<std::array<std::array<double, BATCH>, COORDINATES_PER_STROKE>, 2> coords;
+	for(size_t begin = 0; begin < lines.size(); begin += BATCH) {
+		const size_t count = std::min(BATCH, lines.size() - begin);
+		for(size_t i = 0; i < count; i++) {
+			const Line &line = lines[begin + i];
+			x1[i] = static_cast<int>(line[0][0]);
+			y1[i] = static_cast<int>(line[0][1]);
+			x2[i] = static_cast<int>(line[1][0]);
+			y2[i] = static_cast<int>(line[1][1]);
+		}
+		for(size_t i = 0; i < count; i++) {
+			const double lengthSq = (x1[i] - x2[i]) * (x1[i] - x2[i]) + (y1[i] - y2[i]) * (y1[i] - y2[i]);
+			const double length = sqrt(lengthSq);
+			roughnessGain[i] = length < 200 ? 1 : (length > 500 ? 0.4 : (-0.0016668) * length + 1.233334);
+			offset[i] = (o.maxRandomnessOffset * o.maxRandomnessOffset * 100) > lengthSq ? length / 10 : o.maxRandomnessOffset;
+		}
+		randomsWithOptions(std::span<double>(drawn).first(count * randomsPerLine), o);
+		for(size_t i = 0; i < count; i++) {
+			for(size_t k = 0; k < randomsPerLine; k++) {
+				randoms[k][i] = drawn[i * randomsPerLine + k];
+			}
+		}
+
+		for(size_t stroke = 0; stroke < strokes; stroke++) {
+			const auto r = std::span(randoms).subspan(stroke * RANDOMS_PER_STROKE, RANDOMS_PER_STROKE);
+			auto &c = coords[stroke];
+			for(size_t i = 0; i < count; i++) {
+				const double gain = roughnessGain[i];
+				const double strokeOffset = stroke ? offset[i] / 2 : offset[i];
+				const double divergePoint = 0.2 + r[DIVERGE][i] * 0.2;
+				const double midDispX = jitter(r[MID_DISP_X][i], o.bowing * o.maxRandomnessOffset * (y2[i] - y1[i]) / 200, gain);
+				const double midDispY = jitter(r[MID_DISP_Y][i], o.bowing * o.maxRandomnessOffset * (x1[i] - x2[i]) / 200, gain);
+				c[MOVE_TO_X][i] = x1[i] + jitter(r[MOVE_X][i], strokeOffset, gain);
+				c[MOVE_TO_Y][i] = y1[i] + jitter(r[MOVE_Y][i], strokeOffset, gain);
+				c[CURVE_X1][i] = midDispX + x1[i] + (x2[i] - x1[i]) * divergePoint + jitter(r[CONTROL1_X][i], strokeOffset, gain);
+				c[CURVE_Y1][i] = midDispY + y1[i] + (y2[i] - y1[i]) * divergePoint + jitter(r[CONTROL1_Y][i], strokeOffset, gain);
+				c[CURVE_X2][i] = midDispX + x1[i] + 2 * (x2[i] - x1[i]) * divergePoint + jitter(r[CONTROL2_X][i], strokeOffset, gain);
+				c[CURVE_Y2][i] = midDispY + y1[i] + 2 * (y2[i] - y1[i]) * divergePoint + jitter(r[CONTROL2_Y][i], strokeOffset, gain);
+				c[CURVE_X][i] = x2[i] + jitter(r[END_X][i], strokeOffset, gain);
+				c[CURVE_Y][i] = y2[i] + jitter(r[END_Y][i], strokeOffset, gain);
+			}
+		}
+
+		for(size_t i = 0; i < count; i++) {
+			for(size_t stroke = 0; stroke < strokes; stroke++) {
+				const auto &c = coords[stroke];
+				sink.moveTo(c[MOVE_TO_X][i], c[MOVE_TO_Y][i]);
+				sink.bezierCurveTo(c[CURVE_X1][i], c[CURVE_Y1][i], c[CURVE_X2][i], c[CURVE_Y2][i], c[CURVE_X][i], c[CURVE_Y][i]);
+			}
+		}
+	}
+}
+
+template <GraphicsSink Sink>
+RoughOptions BasicRenderer<Sink>::cloneOptionsAlterSeed(const RoughOptions &options)
+{
+	RoughOptions result{ options };
+	if(options.seed) {
+		// like the new randomizer of rough.js, the altered seed starts over,
+		// 0 stands for rand(), so the largest seed wraps around to 1
+		result.seed = options.seed + 1;
+		if(!result.seed) {
+			result.seed = 1;
+		}
+		std::erase_if(randoms, [&result](const RandomBlock &random) { return random.seed() == result.seed; });
+		currentRandom = nullptr;
+	}
+	return result;
+}
+
+template <GraphicsSink Sink>
+void BasicRenderer<Sink>::randomsWithOptions(std::span<double> out, const RoughOptions &options)
+{
+	if(!currentRandom || currentRandom->seed() != options.seed) {
+		currentRandom = &randomForSeed(options.seed);
+	}
+	currentRandom->next(out);
+}
+
+template <GraphicsSink Sink>
+RoughOptions BasicRenderer<Sink>::strokeDetail(double extent, const RoughOptions &o)
+{
+	RoughOptions result{ o };
+	if(extent < o.lodStrokeExtent && !o.disableMultiStroke) {
+		result.disableMultiStroke = true;
+		downgradedStrokeCount++;
+	}
+	return result;
+}
+
+template <GraphicsSink Sink>
+RandomBlock &BasicRenderer<Sink>::randomForSeed(uint64_t seed)
+{
+	for(RandomBlock &random : randoms) {
+		if(random.seed() == seed) {
+			return random;
+		}
+	}
+	return randoms.emplace_back(seed);
+}
+
+template <GraphicsSink Sink>
+double BasicRenderer<Sink>::offset(double min, double max, const RoughOptions &o, double roughnessGain)
+{
+	return o.roughness * roughnessGain * ((randomWithOptions(o) * (max - min)) + min);
+}
+
+template <GraphicsSink Sink>
+double BasicRenderer<Sink>::offsetOpt(double x, const RoughOptions &o, double roughnessGain)
+{
+	return offset(-x, x, o, roughnessGain);
+}
+
+template <GraphicsSink Sink>
+void BasicRenderer<Sink>::doubleLine(double x1, double y1, double x2, double y2, const RoughOptions &o, bool filling)
+{
+	const bool singleStroke = filling ? o.disableMultiStrokeFill : o.disableMultiStroke;
+	privateLine(x1, y1, x2, y2, o, true, false);
+	if(!singleStroke) {
+                privateLine(x1, y1, x2, y2, o, true, true);
+	}
+}
+
+template <GraphicsSink Sink>
+void BasicRenderer<Sink>::privateLine(int x1, int y1, int x2, int y2, const RoughOptions &o, bool move, bool overlay)
+{
+	const double lengthSq = pow((x1 - x2), 2) + pow((y1 - y2), 2);
+	const double length = sqrt(lengthSq);
+
+	double roughnessGain = 1;
+	if(length < 200) {
+		roughnessGain = 1;
+	} else if(length > 500) {
+		roughnessGain = 0.4;
+	} else {
+		roughnessGain = (-0.0016668) * length + 1.233334;
+	}
+
+	double offset = o.maxRandomnessOffset;
+	if((offset * offset * 100) > lengthSq) {
+		offset = length / 10;
+	}
+
+	const double strokeOffset = overlay ? offset / 2 : offset;
+	const double divergePoint = 0.2 + randomWithOptions(o) * 0.2;
+	const double midDispX = offsetOpt(o.bowing * o.maxRandomnessOffset * (y2 - y1) / 200, o, roughnessGain);
+	const double midDispY = offsetOpt(o.bowing * o.maxRandomnessOffset * (x1 - x2) / 200, o, roughnessGain);
+
+	// The offsets are drawn in a fixed order, the one GCC used to evaluate
+	// them as arguments of moveTo() and bezierCurveTo(), so that sketches of
+	// a seed stay the same. linesFillOps() draws them in this order as well.
+	if(move) {
+		const double moveY = offsetOpt(strokeOffset, o, roughnessGain);
+		const double moveX = offsetOpt(strokeOffset, o, roughnessGain);
+		sink.moveTo(x1 + moveX, y1 + moveY);
+	}
+	const double endY = offsetOpt(strokeOffset, o, roughnessGain);
+	const double endX = offsetOpt(strokeOffset, o, roughnessGain);
+	const double control2Y = offsetOpt(strokeOffset, o, roughnessGain);
+	const double control2X = offsetOpt(strokeOffset, o, roughnessGain);
+	const double control1Y = offsetOpt(strokeOffset, o, roughnessGain);
+	const double control1X = offsetOpt(strokeOffset, o, roughnessGain);
+	sink.bezierCurveTo(midDispX + x1 + (x2 - x1) * divergePoint + control1X,
+			midDispY + y1 + (y2 - y1) * divergePoint + control1Y,
+			midDispX + x1 + 2 * (x2 - x1) * divergePoint + control2X,
+			midDispY + y1 + 2 * (y2 - y1) * divergePoint + control2Y,
+			x2 + endX,
+			y2 + endY);
+}
+
+template <GraphicsSink Sink>
+void BasicRenderer<Sink>::curveWithOffset(const std::vector<Point> &points, double offset, const RoughOptions &o)
+{
+	std::vector<Point> ps;
+	ps.emplace_back(makePoint({points[0][0] + offsetOpt(offset, o),
+			points[0][1] + offsetOpt(offset, o)}));
+	ps.emplace_back(makePoint({points[0][0] + offsetOpt(offset, o),
+			points[0][1] + offsetOpt(offset, o)}));
+	for(size_t i = 1; i < points.size(); i++) {
+		ps.emplace_back(makePoint({points[i][0] + offsetOpt(offset, o),
+				points[i][1] + offsetOpt(offset, o)}));
+		if(i == (points.size() - 1)) {
+			ps.emplace_back(makePoint({points[i][0] + offsetOpt(offset, o),
+					points[i][1] + offsetOpt(offset, o)}));
+		}
+	}
+	curve(ps, std::nullopt, o);
+}
+
+template <GraphicsSink Sink>
+void BasicRenderer<Sink>::curve(const std::vector<Point> &points, std::optional<Point> closePoint, const RoughOptions &o)
+{
+	const size_t len = points.size();
+	if(len > 3) {
+		std::array<Point, 4> b;
+		const double s = 1 - o.curveTightness;
+		sink.moveTo(points[1][0], points[1][1]);
+		for(size_t i = 1; (i + 2) < len; i++) {
+			const Point cachedVertArray = points[i];
+			b[0] = Point{cachedVertArray[0], cachedVertArray[1]};
+			b[1] = makePoint({cachedVertArray[0] + (s * points[i + 1][0] - s * points[i - 1][0]) / 6, cachedVertArray[1] + (s * points[i + 1][1] - s * points[i - 1][1]) / 6});
+			b[2] = makePoint({points[i + 1][0] + (s * points[i][0] - s * points[i + 2][0]) / 6, points[i + 1][1] + (s * points[i][1] - s * points[i + 2][1]) / 6});
+			b[3] = Point{points[i + 1][0], points[i + 1][1]};
+			sink.bezierCurveTo(b[1][0], b[1][1], b[2][0], b[2][1], b[3][0], b[3][1]);
+		}
+		if(closePoint.has_value()) {
+			const double ro = o.maxRandomnessOffset;
+			// drawn in a fixed order, see privateLine()
+			const double offsetY = offsetOpt(ro, o);
+			const double offsetX = offsetOpt(ro, o);
+			sink.lineTo(closePoint.value()[0] + offsetX, closePoint.value()[1] + offsetY);
+		}
+	} else if(len == 3) {
+		sink.moveTo(points[1][0], points[1][1]);
+		sink.bezierCurveTo(points[1][0], points[1][1],
+				points[2][0], points[2][1],
+				points[2][0], points[2][1]);
+	} else if(len == 2) {
+		doubleLine(points[0][0], points[0][1], points[1][0], points[1][1], o);
+	}
+}
+
+template <GraphicsSink Sink>
+std::tuple<std::vector<Point>, std::vector<Point>> BasicRenderer<Sink>::computeEllipsePoints(double increment, double cx, double cy, double rx, double ry, double offset, double overlap, const RoughOptions &o)
+{
+	std::vector<Point> corePoints;
+	std::vector<Point> allPoints;
+	const double radOffset = offsetOpt(0.5, o) - (M_PI / 2);
+	// the angles are reached by rotation, cos() and sin() are called only
+	// for the start, the increment and the overlap
+	const auto start = Geometry::UnitVector::of(radOffset);
+	const auto stepRotation = Geometry::UnitVector::of(increment);
+	const auto halfOverlap = start.rotated(Geometry::UnitVector::of(overlap * 0.5));
+	const auto fullOverlap = halfOverlap.rotated(Geometry::UnitVector::of(overlap * 0.5));
+
+	const auto before = start.rotated(stepRotation.inverse());
+	allPoints.emplace_back(makePoint({offsetOpt(offset, o) + cx + 0.9 * rx * before.cosine,
+			offsetOpt(offset, o) + cy + 0.9 * ry * before.sine}));
+
+	Geometry::AngleSteps step(start, stepRotation);
+	for(double angle = radOffset; angle < (M_PI * 2 + radOffset - 0.01); angle = angle + increment, ++step) {
+		const Point p = makePoint({offsetOpt(offset, o) + cx + rx * step->cosine,
+				offsetOpt(offset, o) + cy + ry * step->sine});
+		corePoints.push_back(p);
+		allPoints.push_back(p);
+	}
+
+	allPoints.emplace_back(makePoint({offsetOpt(offset, o) + cx + rx * halfOverlap.cosine,
+			offsetOpt(offset, o) + cy + ry * halfOverlap.sine}));
+
+	allPoints.emplace_back(makePoint({offsetOpt(offset, o) + cx + 0.98 * rx * fullOverlap.cosine,
+			offsetOpt(offset, o) + cy + 0.98 * ry * fullOverlap.sine}));
+
+	allPoints.emplace_back(makePoint({offsetOpt(offset, o) + cx + 0.9 * rx * halfOverlap.cosine,
+			offsetOpt(offset, o) + cy + 0.9 * ry * halfOverlap.sine}));
+
+	return { allPoints, corePoints };
+}
+
+template <GraphicsSink Sink>
+void BasicRenderer<Sink>::privateArc(double increment, double cx, double cy, double rx, double ry, double strt, double stp, double offset, const RoughOptions &o)
+{
+	const double radOffset = strt + offsetOpt(0.1, o);
+	const auto start = Geometry::UnitVector::of(radOffset);
+	const auto stepRotation = Geometry::UnitVector::of(increment);
+	std::vector<Point> points;
+	const auto before = start.rotated(stepRotation.inverse());
+	points.emplace_back(makePoint({offsetOpt(offset, o) + cx + 0.9 * rx * before.cosine,
+			offsetOpt(offset, o) + cy + 0.9 * ry * before.sine}));
+	Geometry::AngleSteps step(start, stepRotation);
+	for(double angle = radOffset; angle <= stp; angle = angle + increment, ++step) {
+		points.emplace_back(makePoint({offsetOpt(offset, o) + cx + rx * step->cosine,
+				offsetOpt(offset, o) + cy + ry * step->sine}));
+	}
+	const auto end = Geometry::UnitVector::of(stp);
+	points.emplace_back(makePoint({cx + rx * end.cosine,
+			cy + ry * end.sine}));
+	points.emplace_back(makePoint({cx + rx * end.cosine,
+			cy + ry * end.sine}));
+
+	curve(points, std::nullopt, o);
+}
+
+template <GraphicsSink Sink>
+void BasicRenderer<Sink>::bezierTo(double x1, double y1, double x2, double y2, double x, double y, Point current, const RoughOptions &o)
+{
+	const double ros[2] = { o.maxRandomnessOffset, o.maxRandomnessOffset + 0.3 };
+	double f[2] = { 0.0f, 0.0f };
+	const size_t iterations = o.disableMultiStroke ? 1 : 2;
+	for(size_t i = 0; i < iterations; i++) {
+		if(i == 0) {
+			sink.moveTo(current[0], current[1]);
+		} else {
+			// drawn in a fixed order, see privateLine()
+			const double moveY = offsetOpt(ros[0], o);
+			const double moveX = offsetOpt(ros[0], o);
+			sink.moveTo(current[0] + moveX, current[1] + moveY);
+		}
+		f[0] = x + offsetOpt(ros[i], o, 1);
+		f[1] = y + offsetOpt(ros[i], o, 1);
+
+		const double control2Y = offsetOpt(ros[i], o);
+		const double control2X = offsetOpt(ros[i], o);
+		const double control1Y = offsetOpt(ros[i], o);
+		const double control1X = offsetOpt(ros[i], o);
+		sink.bezierCurveTo(x1 + control1X, y1 + control1Y,
+				x2 + control2X, y2 + control2Y,
+				f[0], f[1]);
+	}
+}
+
+template <GraphicsSink Sink>
+void BasicRenderer<Sink>::fillPath(const std::string &path, const RoughOptions &o)
+{
+	// -> path
+	const auto rings = PointsOnPath::pointRingsOnPath(path, 1, (1 + o.roughness) / 2, o.curveFlattening, o.fillPointBudget);
+	patternFillPolygon(rings, o);
+}
+
+} /* namespace Rough */
+
+#endif /* ROUGH_RENDERER_INL */
@@ -0,0 +1,10 @@
+#include "DotFiller.inl"
+
+namespace Rough {
+namespace Filler {
+
+template class DotFiller<OpSet>;
+template class DotFiller<Graphics>;
+
+} /* namespace Filler */
+} /* namespace Rough */
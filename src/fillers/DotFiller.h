@@ -0,0 +1,37 @@
+#ifndef ROUGH_DOT_FILLER_H
+#define ROUGH_DOT_FILLER_H
+
+#include <span>
+#include <vector>
+
+#include "../Core.h"
+#include "../Graphics.h"
+#include "../OpSet.h"
+
+namespace Rough {
+
+template <GraphicsSink Sink> class BasicRenderer;
+
+namespace Filler {
+
+// Jittered dots at a hachureGap pitch, placed along vertical hachure lines
+template <GraphicsSink Sink>
+class DotFiller
+{
+public:
+	DotFiller(BasicRenderer<Sink> &renderer);
+	void fillPolygon(std::span<const Point> points, const RoughOptions &o);
+
+private:
+	void dotsOnLines(const std::vector<Line> &lines, const RoughOptions &o);
+
+	BasicRenderer<Sink> &renderer;
+};
+
+extern template class DotFiller<OpSet>;
+extern template class DotFiller<Graphics>;
+
+} /* namespace Filler */
+} /* namespace Rough */
+
+#endif /* ROUGH_DOT_FILLER_H */
@@ -0,0 +1,69 @@
+#ifndef ROUGH_DOT_FILLER_INL
+#define ROUGH_DOT_FILLER_INL
+
+#include "DotFiller.h"
+
+#include <algorithm>
+#include <math.h>
+
+#include "ScanLineHachure.h"
+#include "../Geometry.h"
+#include "../Renderer.h"
+
+namespace Rough {
+namespace Filler {
+
+// Dots are tiny, a few points per ellipse are enough
+inline constexpr double DOT_CURVE_STEP_COUNT = 5;
+
+template <GraphicsSink Sink>
+DotFiller<Sink>::DotFiller(BasicRenderer<Sink> &renderer)
+	: renderer(renderer)
+{
+}
+
+template <GraphicsSink Sink>
+void DotFiller<Sink>::fillPolygon(std::span<const Point> points, const RoughOptions &o)
+{
+	// the spans of the scanlines are inside the polygon, thus dots placed on
+	// them need no further inside test
+	RoughOptions o2{ o };
+	o2.hachureAngle = 0;
+	dotsOnLines(ScanLineHachure::polygonHachureLines(points, o2), o);
+}
+
+template <GraphicsSink Sink>
+void DotFiller<Sink>::dotsOnLines(const std::vector<Line> &lines, const RoughOptions &o)
+{
+	const double gap = ScanLineHachure::lineGap(o);
+	const double fweight = o.strokeWidth / 2;
+	const double ro = gap / 4;
+
+	RoughOptions dotOptions{ o };
+	dotOptions.curveStepCount = std::min(o.curveStepCount, DOT_CURVE_STEP_COUNT);
+	// a single closed curve per dot, a second stroke is not visible at
+	// that size but doubles the output
+	dotOptions.disableMultiStroke = true;
+	// dots are small anyway, they are part of a fill and not shapes of
+	// their own to downgrade
+	dotOptions.lodStrokeExtent = 0;
+
+	for(const auto &line : lines) {
+		const double length = Geometry::lineLength(line);
+		const double count = ceil(length / gap) - 1;
+		const double offset = length - (count * gap);
+		const double x = ((line[0][0] + line[1][0]) / 2) - (gap / 4);
+		const double minY = std::min(line[0][1], line[1][1]);
+		for(double i = 0; i < count; i++) {
+			const double y = minY + offset + (i * gap);
+			const double cx = (x - ro) + renderer.randomWithOptions(o) * 2 * ro;
+			const double cy = (y - ro) + renderer.randomWithOptions(o) * 2 * ro;
+			renderer.ellipse(cx, cy, fweight, fweight, dotOptions);
+		}
+	}
+}
+
+} /* namespace Filler */
+} /* namespace Rough */
+
+#endif /* ROUGH_DOT_FILLER_INL */
@@ -1,30 +1,56 @@
 #ifndef ROUGH_HACHURE_FILLER_H
 #define ROUGH_HACHURE_FILLER_H
 
+#include <span>
+#include <vector>
+
 #include "../Core.h"
+#include "../Graphics.h"
+#include "../OpSet.h"
 #include "../Geometry.h"
 
 namespace Rough {
 
-class Renderer;
+template <GraphicsSink Sink> class BasicRenderer;
 
 namespace Filler {
 
+// Polylines packed into one point array, polyline i spans the points from
+// offsets[i] up to offsets[i + 1]
+struct Polylines
+{
+	std::vector<Point> points;
+	std::vector<size_t> offsets{ 0 };
+
+	size_t size() const { return offsets.size() - 1; }
+	std::span<const Point> polyline(size_t i) const
+	{
+		return std::span<const Point>(points).subspan(offsets[i], offsets[i + 1] - offsets[i]);
+	}
+};
+
+template <GraphicsSink Sink>
 class HachureFiller
 {
 public:
-	HachureFiller(Renderer &renderer);
-	void fillPolygon(const std::vector<Point> &points, const RoughOptions &o, bool connectEnds = false);
+	HachureFiller(BasicRenderer<Sink> &renderer);
+	void fillPolygon(std::span<const Point> points, const RoughOptions &o, bool connectEnds = false);
 
-private:
+protected:
 	void renderLines(const std::vector<Line> &lines, const RoughOptions &o);
-	std::vector<Line> connectingLines(const std::vector<Point> &polygon, const std::vector<Line> &lines);
-	bool midPointInPolygon(const std::vector<Point> &polygon, const Line &segment);
-	std::vector<Line> splitOnIntersections(const std::vector<Point> &polygon, const Line &segment);
+	void renderPolylines(const Polylines &polylines, const RoughOptions &o);
+
+private:
+	Polylines connectingLines(const Geometry::PreparedPolygon<Scalar> &polygon, const std::vector<Line> &lines, std::vector<Line> &detached);
+	bool midPointInPolygon(const Geometry::PreparedPolygon<Scalar> &polygon, const Line &segment);
+	std::vector<Line> splitOnIntersections(const Geometry::PreparedPolygon<Scalar> &polygon, const Line &segment);
 
-	Renderer &renderer;
+	BasicRenderer<Sink> &renderer;
 };
 
+extern template class HachureFiller<OpSet>;
+extern template class HachureFiller<Graphics>;
+
 } /* namespace Filler */
 } /* namespace Rough */
 
@@ -0,0 +1,168 @@
+#ifndef ROUGH_HACHURE_FILLER_INL
+#define ROUGH_HACHURE_FILLER_INL
+
+#include "HachureFiller.h"
+
+#include <algorithm>
+#include <optional>
+
+#include "ScanLineHachure.h"
+#include "../Core.h"
+#include "../Geometry.h"
+#include "../Renderer.h"
+
+namespace Rough {
+namespace Filler {
+
+struct IntersectionInfo
+{
+	Point point;
+	double distance;
+};
+
+template <GraphicsSink Sink>
+HachureFiller<Sink>::HachureFiller(BasicRenderer<Sink> &renderer)
+	: renderer(renderer)
+{
+}
+template <GraphicsSink Sink>
+void HachureFiller<Sink>::fillPolygon(std::span<const Point> points, const RoughOptions &o, bool connectEnds)
+{
+	const std::vector<Line> lines = ScanLineHachure::polygonHachureLines(points, o);
+	if(!connectEnds) {
+		renderLines(lines, o);
+		return;
+	}
+
+	// prepared once, all connecting segments are tested against it
+	const Geometry::PreparedPolygon<Scalar> polygon(points);
+	std::vector<Line> detached;
+	renderPolylines(connectingLines(polygon, lines, detached), o);
+	renderLines(detached, o);
+}
+
+template <GraphicsSink Sink>
+void HachureFiller<Sink>::renderLines(const std::vector<Line> &lines, const RoughOptions &o)
+{
+	renderer.linesFillOps(lines, o);
+}
+
+template <GraphicsSink Sink>
+void HachureFiller<Sink>::renderPolylines(const Polylines &polylines, const RoughOptions &o)
+{
+	for(size_t i = 0; i < polylines.size(); i++) {
+		renderer.polylineFillOps(polylines.polyline(i), o);
+	}
+}
+
+// Joins each line with the previous one as long as the segment connecting
+// them lies completely inside the polygon, in a single pass over the lines.
+// The parts of connecting segments leaving the polygon are collected as
+// detached lines.
+template <GraphicsSink Sink>
+Polylines HachureFiller<Sink>::connectingLines(const Geometry::PreparedPolygon<Scalar> &polygon, const std::vector<Line> &lines, std::vector<Line> &detached)
+{
+	Polylines result;
+	for(size_t i = 0; i < lines.size(); i++) {
+		const Line &current = lines[i];
+		bool joined = false;
+		if(i > 0 && Geometry::lineLength(lines[i - 1]) >= 3) {
+			const Line &prev = lines[i - 1];
+			const Line segment{current[0], prev[1]};
+			if(Geometry::lineLength(segment) > 3) {
+				const std::vector<Line> segSplits = splitOnIntersections(polygon, segment);
+				joined = segSplits.size() == 1 && segSplits[0] == segment;
+				if(!joined) {
+					detached.insert(detached.end(), segSplits.begin(), segSplits.end());
+				}
+			}
+		}
+		if(!joined && i > 0) {
+			result.offsets.push_back(result.points.size());
+		}
+		result.points.push_back(current[0]);
+		result.points.push_back(current[1]);
+	}
+	if(!lines.empty()) {
+		result.offsets.push_back(result.points.size());
+	}
+	return result;
+}
+
+template <GraphicsSink Sink>
+bool HachureFiller<Sink>::midPointInPolygon(const Geometry::PreparedPolygon<Scalar> &polygon, const Line &segment)
+{
+	return polygon.contains((segment[0][0] + segment[1][0]) / 2, (segment[0][1] + segment[1][1]) / 2);
+}
+
+template <GraphicsSink Sink>
+std::vector<Line> HachureFiller<Sink>::splitOnIntersections(const Geometry::PreparedPolygon<Scalar> &polygon, const Line &segment)
+{
+	const double error = std::max(5.0, Geometry::lineLength(segment) * 0.1);
+	std::vector<size_t> candidates;
+	polygon.edges().edgesInRange(std::min(segment[0][1], segment[1][1]), std::max(segment[0][1], segment[1][1]), candidates);
+	std::vector<IntersectionInfo> intersections;
+	for(const size_t i : candidates) {
+		const auto [p1, p2] = polygon.edges().edge(i);
+		if(Geometry::doIntersect(p1, p2, segment[0], segment[1])) {
+			const std::optional<Point> ip = Geometry::lineIntersection(p1, p2, segment[0], segment[1]);
+			if(ip.has_value()) {
+				const double d0 = Geometry::lineLength(Line{ip.value(), segment[0]});
+				const double d1 = Geometry::lineLength(Line{ip.value(), segment[1]});
+				if(d0 > error && d1 > error) {
+					intersections.emplace_back(IntersectionInfo{
+							.point = ip.value(),
+							.distance = d0
+						});
+				}
+			}
+		}
+	}
+	if(intersections.size() > 1) {
+		std::ranges::sort(intersections, {}, &IntersectionInfo::distance);
+		std::vector<Point> ips;
+		std::ranges::transform(intersections, std::back_inserter(ips), &IntersectionInfo::point);
+
+		std::array<uint8_t, 2> endsInside;
+		polygon.contains(segment, endsInside);
+		if(!endsInside[0]) {
+			ips.erase(ips.begin());
+		}
+		if(!endsInside[1]) {
+			ips.pop_back();
+		}
+		if(ips.size() <= 1) {
+			if(midPointInPolygon(polygon, segment)) {
+				return std::vector<Line>{ segment };
+			} else {
+				return std::vector<Line>{};
+			}
+		}
+		std::vector<Point> &spoints = ips;// = [segment[0], ...ips, segment[1]];
+		spoints.emplace(spoints.begin(), Point{segment[0]});
+		spoints.emplace_back(Point{segment[1]});
+		// the mid points of all sub segments are tested in one batch
+		std::vector<Point> midPoints;
+		for(size_t i = 0; i < (spoints.size() - 1); i += 2) {
+			midPoints.emplace_back(Point{(spoints[i][0] + spoints[i + 1][0]) / 2, (spoints[i][1] + spoints[i + 1][1]) / 2});
+		}
+		std::vector<uint8_t> inside(midPoints.size());
+		polygon.contains(midPoints, inside);
+		std::vector<Line> slines;
+		for(size_t i = 0; i < midPoints.size(); i++) {
+			if(inside[i]) {
+				slines.emplace_back(Line{ spoints[2 * i], spoints[2 * i + 1] });
+			}
+		}
+		return slines;
+	} else if(midPointInPolygon(polygon, segment)) {
+		return std::vector<Line>{ segment };
+	} else {
+		return std::vector<Line>{};
+	}
+}
+
+} /* namespace Filler */
+} /* namespace Rough */
+
+#endif /* ROUGH_HACHURE_FILLER_INL */
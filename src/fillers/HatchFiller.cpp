@@ -0,0 +1,10 @@
+#include "HatchFiller.inl"
+
+namespace Rough {
+namespace Filler {
+
+template class HatchFiller<OpSet>;
+template class HatchFiller<Graphics>;
+
+} /* namespace Filler */
+} /* namespace Rough */
@@ -0,0 +1,28 @@
+#ifndef ROUGH_HATCH_FILLER_H
+#define ROUGH_HATCH_FILLER_H
+
+#include <span>
+
+#include "../Core.h"
+#include "../OpSet.h"
+#include "HachureFiller.h"
+
+namespace Rough {
+namespace Filler {
+
+// Cross-hatch, hachure lines at hachureAngle and at hachureAngle + 90
+template <GraphicsSink Sink>
+class HatchFiller : public HachureFiller<Sink>
+{
+public:
+	HatchFiller(BasicRenderer<Sink> &renderer);
+	void fillPolygon(std::span<const Point> points, const RoughOptions &o);
+};
+
+extern template class HatchFiller<OpSet>;
+extern template class HatchFiller<Graphics>;
+
+} /* namespace Filler */
+} /* namespace Rough */
+
+#endif /* ROUGH_HATCH_FILLER_H */
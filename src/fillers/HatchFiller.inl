@@ -0,0 +1,30 @@
+#ifndef ROUGH_HATCH_FILLER_INL
+#define ROUGH_HATCH_FILLER_INL
+
+#include "HatchFiller.h"
+#include "HachureFiller.inl"
+
+#include "ScanLineHachure.h"
+#include "../Renderer.h"
+
+namespace Rough {
+namespace Filler {
+
+template <GraphicsSink Sink>
+HatchFiller<Sink>::HatchFiller(BasicRenderer<Sink> &renderer)
+	: HachureFiller<Sink>(renderer)
+{
+}
+
+template <GraphicsSink Sink>
+void HatchFiller<Sink>::fillPolygon(std::span<const Point> points, const RoughOptions &o)
+{
+	// both directions are scanned from one projection of the polygon and
+	// rendered together
+	this->renderLines(ScanLineHachure::polygonCrossHatchLines(points, o), o);
+}
+
+} /* namespace Filler */
+} /* namespace Rough */
+
+#endif /* ROUGH_HATCH_FILLER_INL */
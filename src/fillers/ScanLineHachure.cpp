@@ -1,8 +1,10 @@
 #include "ScanLineHachure.h"
 
 #include <algorithm>
-#include <iterator>
+#include <array>
+#include <future>
 #include <ranges>
+#include <thread>
 #include <vector>
 #include <math.h>
 
@@ -11,142 +13,300 @@
 namespace Rough {
 namespace ScanLineHachure {
 
+// Polygons spanning fewer scanlines per available thread are scanned
+// sequentially, spawning a thread costs more than scanning such a band
+static constexpr size_t MIN_BAND_SCANLINES = 2048;
+
+template <class T>
 struct EdgeEntry
 {
-	double ymin;
-	double ymax;
-	double x;
-	double islope;
+	T ymin;
+	T ymax;
+	T x;
+	T islope;
 };
 
-struct ActiveEdgeEntry {
-	double s;
-	EdgeEntry edge;
+// An edge of the projected polygon with its entry for the sweep of the
+// hachure lines and for the sweep of the perpendicular lines of a
+// cross-hatch, so that both sweeps share one table sorted by their own key
+template <class T>
+struct Edge
+{
+	std::array<EdgeEntry<T>, 2> sweeps;
 };
 
-std::vector<Line> straightHachureLines(std::vector<Point> &points, const RoughOptions &o);
+// The edges crossing the current scanline, kept as separate arrays so that
+// stepping to the next scanline is a plain loop over x and islope
+template <class T>
+struct ActiveEdges
+{
+	std::vector<T> x;
+	std::vector<T> islope;
+	std::vector<T> ymax;
+
+	size_t size() const { return x.size(); }
+
+	void push_back(const EdgeEntry<T> &edge)
+	{
+		x.push_back(edge.x);
+		islope.push_back(edge.islope);
+		ymax.push_back(edge.ymax);
+	}
+
+	// drops the edges ending at or above y, keeps the order of the others
+	void removeEnded(double y)
+	{
+		size_t kept = 0;
+		for(size_t i = 0; i < size(); i++) {
+			if(ymax[i] > y) {
+				x[kept] = x[i];
+				islope[kept] = islope[i];
+				ymax[kept] = ymax[i];
+				kept++;
+			}
+		}
+		x.resize(kept);
+		islope.resize(kept);
+		ymax.resize(kept);
+	}
+
+	// The edges were ordered by x on the previous scanline, stepping and
+	// newly appended edges introduce only few inversions, so insertion sort
+	// is close to linear here
+	void sortByX()
+	{
+		for(size_t i = 1; i < size(); i++) {
+			const T cx = x[i], ci = islope[i], cy = ymax[i];
+			size_t j = i;
+			for(; j > 0 && x[j - 1] > cx; j--) {
+				x[j] = x[j - 1];
+				islope[j] = islope[j - 1];
+				ymax[j] = ymax[j - 1];
+			}
+			x[j] = cx;
+			islope[j] = ci;
+			ymax[j] = cy;
+		}
+	}
 
-std::vector<Line> polygonHachureLines(std::vector<Point> points, const RoughOptions &o)
+	void step(double gap)
+	{
+		T *xs = x.data();
+		const T *islopes = islope.data();
+		for(size_t i = 0; i < size(); i++) {
+			xs[i] = xs[i] + (gap * islopes[i]);
+		}
+	}
+};
+
+// Rotation of the polygon into the frame where hachure lines are horizontal,
+// the quarter turned projection is the one of the perpendicular lines
+class Projection
 {
-	const Point rotationCenter{ 0, 0 };
-	const double angle = round(o.hachureAngle + 90);
-	if(angle) {
-		Geometry::rotatePoints(points, rotationCenter, angle);
+public:
+	Projection(double degrees)
+		: rotated(degrees != 0), turned(false),
+		forwardCos(::cos((M_PI / 180) * degrees)), forwardSin(::sin((M_PI / 180) * degrees)),
+		backwardCos(::cos((M_PI / 180) * -degrees)), backwardSin(::sin((M_PI / 180) * -degrees))
+	{
 	}
-	std::vector<Line> lines = straightHachureLines(points, o);
-	if(angle) {
-		// TODO: rotatePoints(points, rotationCenter, -angle); Not needed, as we're doing a copy
-		Geometry::rotateLines(lines, rotationCenter, -angle);
+
+	Projection quarterTurned() const
+	{
+		Projection result(*this);
+		result.turned = !turned;
+		return result;
+	}
+
+	// turning by 90 degrees only swaps coordinates, thus it is exact
+	template <class T>
+	static BasicPoint<T> quarterTurn(const BasicPoint<T> &p)
+	{
+		return BasicPoint<T>{ -p[1], p[0] };
 	}
-	return lines;
-}
 
-std::vector<Line> straightHachureLines(std::vector<Point> &points, const RoughOptions &o)
+	template <class T>
+	BasicPoint<T> project(const BasicPoint<T> &p) const
+	{
+		const BasicPoint<T> q = rotated ? Geometry::rotatePoint(p, BasicPoint<T>{ 0, 0 }, forwardCos, forwardSin) : p;
+		return turned ? quarterTurn(q) : q;
+	}
+
+	template <class T>
+	BasicPoint<T> unproject(const BasicPoint<T> &p) const
+	{
+		const BasicPoint<T> q = turned ? BasicPoint<T>{ p[1], -p[0] } : p;
+		return rotated ? Geometry::rotatePoint(q, BasicPoint<T>{ 0, 0 }, backwardCos, backwardSin) : q;
+	}
+
+private:
+	const bool rotated;
+	bool turned;
+	const double forwardCos, forwardSin;
+	const double backwardCos, backwardSin;
+};
+
+// Scans the scanlines from k0 up to k1 of the edge table sorted for sweep,
+// scanline k lies k additions of gap above y0. The scanlines before k0 are
+// stepped through by the same additions without emitting lines, so that
+// every band yields exactly the lines of a sequential scan. Edges without
+// extent in y end on the scanline activating them.
+template <class T>
+static void scanBand(std::span<const Edge<T>> edges, size_t sweep, double y0, double gap, size_t k0, size_t k1, const Projection &projection, std::vector<BasicLine<T>> &lines)
 {
-	std::vector<Point> &vertices = points;
-	if(vertices.front() != vertices.back()) {
-		vertices.emplace_back(vertices.front());
-	}
-	std::vector<Line> lines;
-	if(vertices.size() > 2) {
-		double gap = o.hachureGap;
-		if(gap < 0) {
-			gap = o.strokeWidth * 4;
+	ActiveEdges<T> activeEdges;
+	size_t nextEdge = 0;
+	double y = y0;
+	for(size_t k = 0; k < k1; k++) {
+		for(; nextEdge < edges.size() && edges[nextEdge].sweeps[sweep].ymin <= y; nextEdge++) {
+			activeEdges.push_back(edges[nextEdge].sweeps[sweep]);
 		}
-		gap = std::max(gap, 0.1);
-
-		// Create sorted edges table
-		std::vector<EdgeEntry> edges;
-		for(double i = 0; i < vertices.size() - 1; i++) {
-			const Point p1 = vertices[i];
-			const Point p2 = vertices[i + 1];
-			if(p1[1] != p2[1]) {
-				const double ymin = std::min(p1[1], p2[1]);
-				edges.push_back({
-						.ymin = ymin,
-						.ymax = std::max(p1[1], p2[1]),
-						.x = ymin == p1[1] ? p1[0] : p2[0],
-						.islope = (p2[0] - p1[0]) / (p2[1] - p1[1])
-					});
+		activeEdges.removeEnded(y);
+
+		if(k >= k0) {
+			activeEdges.sortByX();
+
+			// fill between the edges
+			for(size_t i = 0; (i + 1) < activeEdges.size(); i = i + 2) {
+				lines.emplace_back(BasicLine<T>{
+						projection.unproject(makePoint<T>({round(activeEdges.x[i]), y})),
+						projection.unproject(makePoint<T>({round(activeEdges.x[i + 1]), y}))
+						});
 			}
 		}
 
-		std::ranges::sort(edges, [](const EdgeEntry &e1, const EdgeEntry &e2) {
-				if(e1.ymin < e2.ymin) {
-					return true;
-				}
-				if(e1.ymin > e2.ymin) {
-					return false;
-				}
-				if(e1.x < e2.x) {
-					return true;
-				}
-				if(e1.x > e2.x) {
-					return false;
-				}
-				if(e1.ymax == e2.ymax) {
-					return true;
-				}
-				return ((e1.ymax - e2.ymax) / abs((e1.ymax - e2.ymax))) <= 0.0;
-			});
-		if(!edges.size()) {
-			return lines;
+		activeEdges.step(gap);
+		y = y + gap;
+	}
+}
+
+double lineGap(const RoughOptions &o)
+{
+	double gap = o.hachureGap;
+	if(gap < 0) {
+		gap = o.strokeWidth * 4;
+	}
+	return std::max(gap, 0.1);
+}
+
+template <class T>
+static EdgeEntry<T> edgeEntry(const BasicPoint<T> &p1, const BasicPoint<T> &p2)
+{
+	const T ymin = std::min(p1[1], p2[1]);
+	return {
+		.ymin = ymin,
+		.ymax = std::max(p1[1], p2[1]),
+		.x = ymin == p1[1] ? p1[0] : p2[0],
+		.islope = (p2[0] - p1[0]) / (p2[1] - p1[1])
+	};
+}
+
+// The edges of the polygon projected for the first sweepCount sweeps, the
+// polygon gets closed if it is not already. Each vertex is projected once,
+// the perpendicular sweep only swaps coordinates by a quarter turn.
+template <class T>
+static std::vector<Edge<T>> projectedEdges(std::span<const BasicPoint<T>> polygon, const Projection &projection, size_t sweepCount)
+{
+	std::vector<Edge<T>> edges;
+	if(polygon.empty()) {
+		return edges;
+	}
+	edges.reserve(polygon.size());
+	auto addEdge = [&](const BasicPoint<T> &p1, const BasicPoint<T> &p2) {
+		Edge<T> &edge = edges.emplace_back();
+		edge.sweeps[0] = edgeEntry(p1, p2);
+		if(sweepCount > 1) {
+			edge.sweeps[1] = edgeEntry(Projection::quarterTurn(p1), Projection::quarterTurn(p2));
 		}
+	};
+	const BasicPoint<T> first = projection.project(polygon[0]);
+	BasicPoint<T> previous = first;
+	for(size_t i = 1; i < polygon.size(); i++) {
+		const BasicPoint<T> current = projection.project(polygon[i]);
+		addEdge(previous, current);
+		previous = current;
+	}
+	if(previous != first) {
+		addEdge(previous, first);
+	}
+	return edges;
+}
 
-		// Start scanning
-		std::vector<ActiveEdgeEntry> activeEdges;
-		double y = edges[0].ymin;
-		while(!activeEdges.empty() || !edges.empty()) {
-			if(edges.size()) {
-				size_t ix = -1;
-				for(size_t i = 0; i < edges.size(); i++) {
-					if(edges[i].ymin > y) {
-						break;
-					}
-					ix = i;
-				}
-				std::ranges::transform(edges | std::ranges::views::take(ix + 1), std::back_inserter(activeEdges), [y](const EdgeEntry &edge) { return ActiveEdgeEntry{.s = y, .edge = edge}; });
-				edges.erase(edges.begin(), edges.begin() + (ix + 1));
-			}
-			std::erase_if(activeEdges, [y](const ActiveEdgeEntry &ae) {
-					if(ae.edge.ymax <= y) {
-						return true;
-					}
-					return false;
-				});
-			
-			std::ranges::sort(activeEdges, [](const ActiveEdgeEntry &ae1, const ActiveEdgeEntry &ae2) {
-					if(ae1.edge.x == ae2.edge.x) {
-						return false;
-					}
-					return ((ae1.edge.x - ae2.edge.x) / abs((ae1.edge.x - ae2.edge.x))) <= 0.0;
-				});
+template <class T>
+static void scanEdges(std::vector<Edge<T>> &edges, size_t sweep, const Projection &projection, double gap, std::vector<BasicLine<T>> &lines)
+{
+	auto entry = [sweep](const Edge<T> &edge) -> const EdgeEntry<T>& { return edge.sweeps[sweep]; };
+	auto spanned = [&](const Edge<T> &edge) { return entry(edge).ymin < entry(edge).ymax; };
+	if(std::ranges::none_of(edges, spanned)) {
+		return;
+	}
+	// only the order of ymin matters, edges are activated by scanning
+	// this table with a cursor
+	std::ranges::sort(edges, {}, [&](const Edge<T> &edge) { return entry(edge).ymin; });
 
-			// fill between the edges
-			if(activeEdges.size() > 1) {
-				for(size_t i = 0; i < activeEdges.size(); i = i + 2) {
-					const size_t nexti = i + 1;
-					if(nexti >= activeEdges.size()) {
-						break;
-					}
-					const EdgeEntry &ce = activeEdges[i].edge;
-					const EdgeEntry &ne = activeEdges[nexti].edge;
-					lines.emplace_back(Line{
-							Point{round(ce.x), y},
-							Point{round(ne.x), y}
-							});
-				}
-			}
+	// the lowest and highest vertices always belong to edges spanning y
+	const double yend = std::ranges::max(edges | std::views::transform([&](const Edge<T> &edge) { return entry(edge).ymax; }));
+	const double y0 = entry(edges[0]).ymin;
+	// the last scanline is the first one reaching yend
+	size_t scanlineCount = 1;
+	for(double y = y0; y < yend; y = y + gap) {
+		scanlineCount++;
+	}
 
-			y += gap;
-			for(auto &ae : activeEdges) {
-				ae.edge.x = ae.edge.x + (gap * ae.edge.islope);
-			};
+	const size_t bandCount = std::min<size_t>(std::max(1u, std::thread::hardware_concurrency()), scanlineCount / MIN_BAND_SCANLINES);
+	if(bandCount <= 1) {
+		scanBand<T>(edges, sweep, y0, gap, 0, scanlineCount, projection, lines);
+	} else {
+		// each band is scanned on its own, the first one on this thread
+		const size_t bandSize = (scanlineCount + bandCount - 1) / bandCount;
+		std::vector<std::future<std::vector<BasicLine<T>>>> bands;
+		for(size_t k0 = bandSize; k0 < scanlineCount; k0 += bandSize) {
+			bands.emplace_back(std::async(std::launch::async, [&, k0]() {
+					std::vector<BasicLine<T>> bandLines;
+					scanBand<T>(edges, sweep, y0, gap, k0, std::min(k0 + bandSize, scanlineCount), projection, bandLines);
+					return bandLines;
+				}));
+		}
+		scanBand<T>(edges, sweep, y0, gap, 0, bandSize, projection, lines);
+		for(auto &band : bands) {
+			const std::vector<BasicLine<T>> bandLines = band.get();
+			lines.insert(lines.end(), bandLines.begin(), bandLines.end());
 		}
 	}
+}
+
+// Instead of rotating a copy of the polygon and the resulting lines, the
+// vertices are projected while building the edge table and the line ends
+// are projected back when they are emitted
+template <class T>
+std::vector<BasicLine<T>> polygonHachureLines(std::span<const BasicPoint<T>> polygon, const RoughOptions &o)
+{
+	const Projection projection(round(o.hachureAngle + 90));
+	std::vector<Edge<T>> edges = projectedEdges(polygon, projection, 1);
+	std::vector<BasicLine<T>> lines;
+	scanEdges(edges, 0, projection, lineGap(o), lines);
 	return lines;
 }
 
+// Both sweeps share the edge table, it is only sorted again for the
+// perpendicular lines
+template <class T>
+std::vector<BasicLine<T>> polygonCrossHatchLines(std::span<const BasicPoint<T>> polygon, const RoughOptions &o)
+{
+	const Projection projection(round(o.hachureAngle + 90));
+	const double gap = lineGap(o);
+	std::vector<Edge<T>> edges = projectedEdges(polygon, projection, 2);
+	std::vector<BasicLine<T>> lines;
+	scanEdges(edges, 0, projection, gap, lines);
+	scanEdges(edges, 1, projection.quarterTurned(), gap, lines);
+	return lines;
+}
+
+template std::vector<BasicLine<float>> polygonHachureLines(std::span<const BasicPoint<float>> polygon, const RoughOptions &o);
+template std::vector<BasicLine<double>> polygonHachureLines(std::span<const BasicPoint<double>> polygon, const RoughOptions &o);
+template std::vector<BasicLine<float>> polygonCrossHatchLines(std::span<const BasicPoint<float>> polygon, const RoughOptions &o);
+template std::vector<BasicLine<double>> polygonCrossHatchLines(std::span<const BasicPoint<double>> polygon, const RoughOptions &o);
+
 } /* namespace ScanLineHachure */
 } /* namespace Rough */
 
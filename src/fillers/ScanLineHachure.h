@@ -1,6 +1,7 @@
 #ifndef ROUGH_FILL_SCANLINE_HACHURE
 #define ROUGH_FILL_SCANLINE_HACHURE
 
+#include <span>
 #include <vector>
 
 #include "../Core.h"
@@ -8,7 +9,12 @@
 namespace Rough {
 namespace ScanLineHachure {
 
-extern std::vector<Line> polygonHachureLines(std::vector<Point> points, const RoughOptions &o);
+// the distance between hachure lines, strokeWidth * 4 if hachureGap is negative
+double lineGap(const RoughOptions &o);
+// instantiated for float and double points
+template <class T> std::vector<BasicLine<T>> polygonHachureLines(std::span<const BasicPoint<T>> polygon, const RoughOptions &o);
+// the hachure lines followed by the ones perpendicular to them
+template <class T> std::vector<BasicLine<T>> polygonCrossHatchLines(std::span<const BasicPoint<T>> polygon, const RoughOptions &o);
 
 } /* namespace ScanLineHachure */
 } /* namespace Rough */
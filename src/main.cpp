@@ -10,40 +10,10 @@
 
 #include "Renderer.h"
 #include "Core.h"
-
-#include "PointsOnPath/PointsOnPath.h"
+#include "PathCache.h"
 
 class State;
 
-class SvgPathRecorder : public Rough::Graphics
-{
-public:
-        std::string getAndClear()
-        {
-                std::string tmp = std::move(path);
-                path.clear();
-                return(tmp);
-        }
-
-	virtual void moveTo(double x, double y)
-        {
-                path += "M " + std::to_string(x) + " " + std::to_string(y) + " ";
-        }
-        virtual void lineTo(double x, double y)
-        {
-                path += "L " + std::to_string(x) + " " + std::to_string(y) + " ";
-        }
-        virtual void bezierCurveTo(double x1, double y1, double x2, double y2, double x3, double y3)
-        {
-                path += "C " + std::to_string(x1) + " " + std::to_string(y1) + " "
-                                + std::to_string(x2) + " " + std::to_string(y2) + " "
-                                + std::to_string(x3) + " " + std::to_string(y3) + " ";
-        }
-
-private:
-        std::string path;
-};
-
 struct State {
         State(FILE *in, FILE *out, const Rough::RoughOptions &roughOptions);
 
@@ -53,16 +23,26 @@ struct State {
         FILE *in;
         FILE *out;
 
-        SvgPathRecorder svgRecorder;
+        Rough::OpSet ops;
         Rough::Renderer renderer;
         Rough::RoughOptions roughOptions;
+        Rough::PathCache pathCache;
 };
 
 State::State(FILE *in, FILE *out, const Rough::RoughOptions &roughOptions)
-        : in(in), out(out), renderer(svgRecorder), roughOptions(roughOptions)
+        : in(in), out(out), renderer(ops), roughOptions(roughOptions)
 {
 }
 
+// the path data of everything the renderer has drawn since the last call
+static std::string takePathData(State &state)
+{
+        std::string path;
+        Rough::opsToPath(state.ops, path);
+        state.ops.clear();
+        return(path);
+}
+
 void expandStyleAttribute(std::map<std::string_view, std::string_view> &attributes, std::string_view style)
 {
     const std::regex ws_re("\\s*([^:\\s]+)\\s*:\\s*([^;\\s]+)\\s*(;\\s*|$)");
@@ -112,7 +92,10 @@ std::string_view extractAttributeOrDefault(std::map<std::string_view, std::strin
         return(node ? node.mapped() : defaultValue);
 }
 
-static void pathOut(State &state, std::string_view path, std::map<std::string_view, std::string_view> &attributes)
+// Writes the fill and the stroke of an element, normalized() and rings()
+// give its geometry, they are only called if it is stroked or filled
+template <class NormalizedFunction, class RingsFunction>
+static void shapeOut(State &state, NormalizedFunction normalized, RingsFunction rings, std::map<std::string_view, std::string_view> &attributes)
 {
         std::string_view fill = extractAttributeOrDefault(attributes, "fill", "none");
         std::string_view stroke = extractAttributeOrDefault(attributes, "stroke", "none");
@@ -126,39 +109,45 @@ static void pathOut(State &state, std::string_view path, std::map<std::string_vi
         if(fill != "none") {
                 const double distance = ((1 + state.roughOptions.roughness) / 2);
 
-                auto sets = Rough::PointsOnPath::pointsOnPath(std::string(path), 1, distance);
-                std::vector<Rough::Point> pointsOnPolygon;
-                for(const auto &set : sets) {
-                        for(const auto &point : set) {
-                                pointsOnPolygon.push_back(point);
-                        }
-                }
-
-                state.renderer.patternFillPolygon(pointsOnPolygon, state.roughOptions);
-                fprintf(state.getOutFile(), "<path fill=\"none\" stroke=\"%s\" stroke-width=\"%.3f\" stroke-linecap=\"round\" d=\"%s\"></path>\n", std::string(fill).c_str(), state.roughOptions.strokeWidth, state.svgRecorder.getAndClear().c_str());
+                const auto &fillRings = rings(distance);
+                state.renderer.patternFillPolygon(fillRings, state.roughOptions);
+                fprintf(state.getOutFile(), "<path fill=\"none\" stroke=\"%s\" stroke-width=\"%.3f\" stroke-linecap=\"round\" d=\"%s\"></path>\n", std::string(fill).c_str(), state.roughOptions.strokeWidth, takePathData(state).c_str());
         }
 
         if(stroke != "none") {
-                state.renderer.svgPath(std::string(path), state.roughOptions);
-                fprintf(state.getOutFile(), "<path fill=\"none\" stroke=\"%s\" stroke-width=\"%.3f\" stroke-linecap=\"round\" d=\"%s\"></path>", std::string(stroke).c_str(), state.roughOptions.strokeWidth, state.svgRecorder.getAndClear().c_str());
+                state.renderer.svgPath(normalized(), state.roughOptions);
+                fprintf(state.getOutFile(), "<path fill=\"none\" stroke=\"%s\" stroke-width=\"%.3f\" stroke-linecap=\"round\" d=\"%s\"></path>", std::string(stroke).c_str(), state.roughOptions.strokeWidth, takePathData(state).c_str());
         }
 
         fprintf(state.getOutFile(), "</g>");
 }
 
+// an element given by path data or points, its geometry comes from the cache
+static void pathOut(State &state, std::string_view path, Rough::PathCache::Source source, std::map<std::string_view, std::string_view> &attributes)
+{
+        state.pathCache.beginElement();
+        shapeOut(state,
+                [&]() -> const Rough::PathDataParser::Path & {
+                        return(state.pathCache.normalized(path, source));
+                },
+                [&](double distance) -> const Rough::PointsOnPath::PointRings & {
+                        return(state.pathCache.pointsOnPath(path, 1, distance, state.roughOptions.curveFlattening, state.roughOptions.fillPointBudget, source));
+                },
+                attributes);
+}
+
 static void sketchifyPath(State &state, const char **attributes_in)
 {
         auto attributes = makeAttributesMap(attributes_in);
 
-        pathOut(state, extractAttributeOrDefault(attributes, "d"), attributes);
+        pathOut(state, extractAttributeOrDefault(attributes, "d"), Rough::PathCache::Source::PathData, attributes);
 }
 
 static void sketchifyPolygon(State &state, const char **attributes_in)
 {
         auto attributes = makeAttributesMap(attributes_in);
 
-        std::string path = "M " + std::string(extractAttributeOrDefault(attributes, "points"));
-        pathOut(state, path, attributes);
+        pathOut(state, extractAttributeOrDefault(attributes, "points"), Rough::PathCache::Source::Points, attributes);
 }
 
 static void sketchifyRect(State &state, const char **attributes_in)
@@ -170,14 +159,22 @@ static void sketchifyRect(State &state, const char **attributes_in)
         double width = std::atof(extractAttributeOrDefault(attributes, "width", "0.0").data());
         double height = std::atof(extractAttributeOrDefault(attributes, "height", "0.0").data());
 
-        std::string path =
-                "M " + std::to_string(x) + "," + std::to_string(y) + 
-                "L " + std::to_string(x + width) + "," + std::to_string(y) + 
-                "L " + std::to_string(x + width) + "," + std::to_string(y + height) + 
-                "L " + std::to_string(x) + "," + std::to_string(y + height) + 
-                "L " + std::to_string(x) + "," + std::to_string(y);
-
-        pathOut(state, path, attributes);
+        // built directly, there is no path data to parse
+        Rough::PathDataParser::Path path;
+        path.append('M', { x, y });
+        path.append('L', { x + width, y });
+        path.append('L', { x + width, y + height });
+        path.append('L', { x, y + height });
+        path.append('L', { x, y });
+
+        shapeOut(state,
+                [&]() -> const Rough::PathDataParser::Path & {
+                        return(path);
+                },
+                [&](double distance) {
+                        return(Rough::PointsOnPath::pointRingsOnPath(path, 1, distance, state.roughOptions.curveFlattening, state.roughOptions.fillPointBudget));
+                },
+                attributes);
 }
 
 static void sketchifyEllipse(State &state, const char **attributes_in)
@@ -195,7 +192,7 @@ static void sketchifyEllipse(State &state, const char **attributes_in)
         auto ellipseParams = state.renderer.generateEllipseParams(2 * rx, 2 * ry, state.roughOptions);
         auto ellipseResponse = state.renderer.ellipseWithParams(cx, cy, state.roughOptions, ellipseParams);
 
-        std::string strokePathD = state.svgRecorder.getAndClear();
+        std::string strokePathD = takePathData(state);
 
         fprintf(state.getOutFile(), "<g");
         for(const auto &attribute : attributes) {
@@ -209,7 +206,7 @@ static void sketchifyEllipse(State &state, const char **attributes_in)
 
         if(fill != "none") {
                 state.renderer.patternFillPolygon(ellipseResponse, state.roughOptions);
-                fprintf(state.getOutFile(), "<path fill=\"none\" stroke-width=\"0.5\" stroke=\"%s\" d=\"%s\"></path>", std::string(stroke).c_str(), state.svgRecorder.getAndClear().c_str());
+                fprintf(state.getOutFile(), "<path fill=\"none\" stroke-width=\"0.5\" stroke=\"%s\" d=\"%s\"></path>", std::string(stroke).c_str(), takePathData(state).c_str());
         }
 
         fprintf(state.getOutFile(), "</g>");
@@ -253,7 +250,7 @@ static void XMLCALL characterData(void *userData, const XML_Char *data, int len)
         fwrite(data, len, 1, state->getOutFile());
 }
 
-static bool processSvg(FILE *in, FILE *out, const Rough::RoughOptions &roughOptions)
+static bool processSvg(FILE *in, FILE *out, const Rough::RoughOptions &roughOptions, bool statistics)
 {
         char buf[BUFSIZ];
 	XML_Parser parser = XML_ParserCreate(NULL);
@@ -276,6 +273,11 @@ static bool processSvg(FILE *in, FILE *out, const Rough::RoughOptions &roughOpti
 	} while(!done);
 	XML_ParserFree(parser);
 
+        if(statistics) {
+                fprintf(stderr, "path cache: %zu hits, %zu misses, hit rate %.1f%%\n", state.pathCache.hits(), state.pathCache.misses(), state.pathCache.hitRate() * 100);
+                fprintf(stderr, "level of detail: %zu strokes, %zu fills downgraded\n", state.renderer.downgradedStrokes(), state.renderer.downgradedFills());
+        }
+
         return(true);
 }
 
@@ -284,6 +286,7 @@ struct Config
         Rough::RoughOptions roughOptions;
         std::string infile;
         std::string outfile;
+        bool statistics;
 };
 
 static char doc[] = "make svg files look sketchy - rough.js translated into c++";
@@ -300,10 +303,17 @@ static struct argp_option options[] = {
         { "curve-tightness", 258, "ratio", 0, "number (0-1) indicating how thight curve-points follow the original points" },
         { "curve-fitting", 259, "ratio", 0, "number (0-1) indicating how close curves follow original curves" },
         { "curve-step-count", 260, "number", 0, "number of points to estimate the shape" },
+        { "curve-flattening", 264, "mode", 0, "how curves of filled shapes are split into points: adaptive (default) or fixed" },
+        { "fill-style", 266, "style", 0, "how shapes are filled: hachure (default), cross-hatch, zigzag or dots" },
         { "hachure-angle", 261, "angle", 0, "angle of hachure" },
         { "hachure-gap", 262, "distance", 0, "gap between hachure lines" },
+        { "fill-point-budget", 265, "number", 0, "simplify each outline of a filled shape to at most number points (Visvalingam-Whyatt)" },
+        { "lod-stroke", 268, "extent", 0, "draw shapes smaller than extent units with a single stroke and fewer ellipse steps" },
+        { "lod-fill", 269, "extent", 0, "fill shapes smaller than extent units with a single stroke instead of a pattern" },
+        { "seed", 267, "number", 0, "seed of the random numbers, the same seed always gives the same sketch" },
         { "stroke-width", 'w', "width", 0, "width of sketchy strokes" },
         { "out", 'o', "file", 0, "place the output into file" },
+        { "statistics", 263, 0, OPTION_ARG_OPTIONAL, "print statistics (like the path cache hit rate) to stderr" },
         { 0 }
 };
 
@@ -323,8 +333,53 @@ static error_t parse_opt(int key, char *arg, struct argp_state *state)
                         case 260: config->roughOptions.curveStepCount = std::stod(arg); break;
                         case 261: config->roughOptions.hachureAngle = std::stod(arg); break;
                         case 262: config->roughOptions.hachureGap = std::stod(arg); break;
+                        case 265: config->roughOptions.fillPointBudget = std::stoul(arg); break;
+                        case 267:
+                                // a seed that cannot be used is an error
+                                // rather than a silent fallback to rand(),
+                                // std::stoull() would negate a negative seed
+                                try {
+                                        size_t end = 0;
+                                        if(strchr(arg, '-')) {
+                                                argp_error(state, "invalid seed: %s", arg);
+                                        }
+                                        config->roughOptions.seed = std::stoull(arg, &end);
+                                        if(arg[end] != '\0') {
+                                                argp_error(state, "invalid seed: %s", arg);
+                                        }
+                                } catch(std::invalid_argument &e) {
+                                        argp_error(state, "invalid seed: %s", arg);
+                                } catch(std::out_of_range &e) {
+                                        argp_error(state, "seed out of range: %s", arg);
+                                }
+                                break;
+                        case 268: config->roughOptions.lodStrokeExtent = std::stod(arg); break;
+                        case 269: config->roughOptions.lodFillExtent = std::stod(arg); break;
                         case 'w': config->roughOptions.strokeWidth = std::stod(arg); break;
                         case 'o': config->outfile = arg; break; 
+                        case 263: config->statistics = true; break;
+                        case 264:
+                                if(!strcmp(arg, "adaptive")) {
+                                        config->roughOptions.curveFlattening = Rough::CurveFlattening::Adaptive;
+                                } else if(!strcmp(arg, "fixed")) {
+                                        config->roughOptions.curveFlattening = Rough::CurveFlattening::FixedCount;
+                                } else {
+                                        fprintf(stderr, "invalid curve flattening: %s\n", arg);
+                                }
+                                break;
+                        case 266:
+                                if(!strcmp(arg, "hachure")) {
+                                        config->roughOptions.fillStyle = Rough::FillStyle::Hachure;
+                                } else if(!strcmp(arg, "cross-hatch")) {
+                                        config->roughOptions.fillStyle = Rough::FillStyle::CrossHatch;
+                                } else if(!strcmp(arg, "zigzag")) {
+                                        config->roughOptions.fillStyle = Rough::FillStyle::ZigZag;
+                                } else if(!strcmp(arg, "dots")) {
+                                        config->roughOptions.fillStyle = Rough::FillStyle::Dots;
+                                } else {
+                                        fprintf(stderr, "invalid fill style: %s\n", arg);
+                                }
+                                break;
 
                         case ARGP_KEY_ARG:
                                 if(state->arg_num > 1)
@@ -341,6 +396,8 @@ static error_t parse_opt(int key, char *arg, struct argp_state *state)
                 }
         } catch(std::invalid_argument &e) {
                 fprintf(stderr, "invalid number: %s\n", arg);
+        } catch(std::out_of_range &e) {
+                fprintf(stderr, "number out of range: %s\n", arg);
         }
 
         return 0;
@@ -362,10 +419,17 @@ int main(int argc, char *argv[])
                         .curveStepCount = 9,
                         .hachureAngle = -41,
                         .hachureGap = 3,
-                        .strokeWidth = 0.5
+                        .strokeWidth = 0.5,
+                        .curveFlattening = Rough::CurveFlattening::Adaptive,
+                        .fillPointBudget = 0,
+                        .fillStyle = Rough::FillStyle::Hachure,
+                        .seed = 0,
+                        .lodStrokeExtent = 0,
+                        .lodFillExtent = 0
                 },
                 .infile = "-",
-                .outfile = "-"
+                .outfile = "-",
+                .statistics = false
         };
         argp_parse(&argp, argc, argv, 0, 0, &config);
 
@@ -385,5 +449,5 @@ int main(int argc, char *argv[])
         }
 
 
-        return(processSvg(in, out, config.roughOptions) ? 0 : 1);
+        return(processSvg(in, out, config.roughOptions, config.statistics) ? 0 : 1);
 }